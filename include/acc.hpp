@@ -1,6 +1,7 @@
 #pragma once
 
 #include "structs.hpp"
+#include "spatial_index.hpp"
 #include <vector>
 
 /**
@@ -10,14 +11,71 @@
  * Central difference is used when both previous and next timesteps are available.
  * Forward/backward difference is used at the edges.
  *
- * @param prev   Wavefield at t - Δt (can be empty)
+ * @param prev   Wavefield at t - Δt (can be empty, or curr itself at t = 0)
  * @param curr   Wavefield at current timestep t (will be updated)
  * @param next   Wavefield at t + Δt (can be empty)
  * @param delta_t Time step size
  */
 void computeAcceleration_from_context(
-    const std::vector<WavefieldEntry>& prev,
-    std::vector<WavefieldEntry>& curr,
-    const std::vector<WavefieldEntry>& next,
+    const GridFrame& prev,
+    GridFrame& curr,
+    const GridFrame& next,
     double delta_t
-);
\ No newline at end of file
+);
+
+/**
+ * Frames of the time-difference stencil around curr: raw frames
+ * (AccelerationFrames) or frames interpolated to the target points. prev2 and
+ * next2 are only used by the five-point stencil; a missing frame is nullptr or
+ * empty.
+ */
+template <typename Frame>
+struct StencilFrames {
+    const Frame* prev2 = nullptr;
+    const Frame* prev = nullptr;
+    const Frame* curr = nullptr;
+    const Frame* next = nullptr;
+    const Frame* next2 = nullptr;
+};
+using AccelerationFrames = StencilFrames<Wavefield>;
+
+/**
+ * True if the raw frames the stencil of the given order reads have curr's
+ * points (same size, same x, y and z per point), as on a static grid. On
+ * NHFLOW's sigma grid z moves with the free surface, and the same point index
+ * is no longer the same place in space.
+ */
+bool stencil_shares_layout(const AccelerationFrames& frames, int order);
+
+/**
+ * Interpolates the fields of curr (InterpField mask, see cloud.hpp) and their
+ * acceleration in one pass over curr's neighbours.
+ *
+ * IDW is linear in the values, so the time difference is taken on the raw
+ * velocities of the stencil frames and interpolated with curr's weights
+ * instead of interpolating every frame. With order 4 the five-point central
+ * difference (v[-2] - 8 v[-1] + 8 v[+1] - v[+2]) / (12 Δt) is used where all
+ * four neighbours exist; otherwise the three-point rules of
+ * computeAcceleration_from_context apply. ay is zero without FIELD_VY.
+ *
+ * This is the acceleration at the target points only if the stencil shares
+ * curr's layout (stencil_shares_layout); otherwise false is returned and out
+ * is left untouched.
+ */
+bool interpolate_fields_with_acceleration(const AccelerationFrames& frames,
+                                          const NeighbourList& neighbours,
+                                          unsigned fields,
+                                          double delta_t,
+                                          int order,
+                                          GridFrame& out);
+
+/**
+ * Acceleration from the velocities of frames interpolated to the same target
+ * points, with the stencils of interpolate_fields_with_acceleration. Used when
+ * the raw points move between frames. Writes ax, ay and az of out (ay is zero
+ * if the frames hold no vy).
+ */
+void computeAcceleration_from_frames(const StencilFrames<GridFrame>& frames,
+                                     double delta_t,
+                                     int order,
+                                     GridFrame& out);
\ No newline at end of file
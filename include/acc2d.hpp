@@ -7,8 +7,8 @@
  * Assumes vy = ay = 0.0 for all entries.
  */
 void computeAcceleration2D_from_context(
-    const std::vector<WavefieldEntry>& prev,
-    std::vector<WavefieldEntry>& curr,
-    const std::vector<WavefieldEntry>& next,
+    const GridFrame& prev,
+    GridFrame& curr,
+    const GridFrame& next,
     double delta_t
-);
\ No newline at end of file
+);
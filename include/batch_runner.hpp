@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * One case of a batch run: the answers and flags of an interactive run plus the input
+ * and output locations.
+ */
+struct CaseSettings {
+    std::string name;               // shown in the progress report
+    std::string control_file;       // <data>/control.txt
+    std::string ctrl_file;          // <data>/ctrl.txt
+    std::string wavefield_file;     // the one CSV in <data> unless given
+    std::string output_dir;         // default <data>/../output
+    bool is2D = false;
+    std::string elevation_mode = "e";
+    bool use_wheeler = false;
+    int acceleration_order = 2;
+    bool write_csv = false;
+    bool use_frame_cache = false;
+    int timestep_workers = 1;
+    int export_threads = 0;
+    double y_total = 0.0;           // 2D only: Y domain width and NY of the broadcast
+    int ny = 0;
+    int threads = 0;                // OpenMP threads, 0 = share of the batch budget
+};
+
+/**
+ * Reads a case manifest: one case per line as whitespace-separated key=value
+ * settings, '#' starts a comment. Keys:
+ *
+ *   data=DIR          folder with control.txt, ctrl.txt and the wavefield CSV (required)
+ *   csv=FILE          wavefield CSV, if the folder holds several
+ *   output=DIR        output folder (default DIR/../output of data)
+ *   name=NAME         case name (default: name of the output folder, else of data's parent)
+ *   elevation=z|e     wheeler=y|n     order=2|4     write_csv=y|n     cache=y|n
+ *   workers=N         export_threads=N     threads=N
+ *   y_width=W ny=N    Y domain width and NY, required for 2D cases
+ *
+ * Relative paths are relative to the manifest. Throws std::runtime_error with
+ * the line number on an invalid entry.
+ */
+std::vector<CaseSettings> read_case_manifest(const std::string& path);
+
+/**
+ * Runs one case in the calling process (the output folder must exist).
+ */
+void run_case(const CaseSettings& c);
+
+/**
+ * Runs the cases in worker processes, up to jobs at a time (0 = as many as
+ * the thread budget allows). Each case gets its own threads, or an equal share
+ * of the free part of the thread budget (0 = number of cores) when it starts, so
+ * the last cases of a batch get the threads of the finished ones. The output of
+ * a case goes to REEF2FAST.log in its output folder.
+ *
+ * @return Number of failed cases
+ */
+int run_batch(const std::vector<CaseSettings>& cases, int jobs, int thread_budget);
\ No newline at end of file
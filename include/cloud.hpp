@@ -4,13 +4,40 @@
 #include <array>
 #include <string>
 #include "structs.hpp"
+#include "spatial_index.hpp"
 
 // Grid generation for 3D SeaState
 void generate_seastate_grid_targets(const std::string& control_file,
                                     std::vector<std::array<double, 3>>& targets);
 
 // Interpolation to target grid
-std::vector<double> interpolate_to_grid(const Wavefield& wf,
-                                        const std::vector<std::array<double, 3>>& target_pts,
-                                        const std::string& field,
-                                        int k = 8);
\ No newline at end of file
+std::vector<Value> interpolate_to_grid(const Wavefield& wf,
+                                       const std::vector<std::array<double, 3>>& target_pts,
+                                       const std::string& field,
+                                       int k = 8);
+
+// Fields that can be interpolated in one pass (combine as bit mask)
+enum InterpField : unsigned {
+    FIELD_VX       = 1u << 0,
+    FIELD_VY       = 1u << 1,
+    FIELD_VZ       = 1u << 2,
+    FIELD_PRESSURE = 1u << 3
+};
+
+// Interpolation with neighbours from a SpatialIndex (2D or 3D)
+std::vector<Value> interpolate_to_grid(const Wavefield& wf,
+                                       const NeighbourList& neighbours,
+                                       const std::string& field);
+
+// Interpolates all fields in the mask into the columns of out in a single
+// pass over the neighbours; columns of other fields are left untouched
+void interpolate_fields(const Wavefield& wf,
+                        const NeighbourList& neighbours,
+                        unsigned fields,
+                        GridFrame& out);
+
+// Same with its own kNN search (one query per target point for all fields)
+GridFrame interpolate_fields_to_grid(const Wavefield& wf,
+                                     const std::vector<std::array<double, 3>>& target_pts,
+                                     unsigned fields,
+                                     int k = 8);
\ No newline at end of file
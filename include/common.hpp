@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cmath>
 #include <string>
 #include <vector>
 
@@ -27,7 +28,8 @@ bool read_control_file(const std::string& filename,
 // Determines if case is 2D by checking if NY == 1 in control.txt
 bool is_2D_case(const std::string& control_file);
 
-// Formats a double into scientific notation for SeaState output
+// Formats a double into scientific notation for SeaState output ("%.4e").
+// Bulk output should use write_scientific()/append_scientific_row() instead.
 std::string format_scientific(double value);
 
 // Utility: Generates a linearly spaced grid with N points
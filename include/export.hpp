@@ -1,36 +1,67 @@
 #pragma once
 
 #include "structs.hpp"
+#include "output_writer.hpp"
+#include "seastate_layout.hpp"
+#include <cstddef>
 #include <string>
-#include <functional>
+#include <vector>
 
 /**
- * Writes a single wave kinematics component (e.g. vx, ax, pressure)
- * to a SeaState-formatted .XXX file.
+ * One SeaState wave kinematics file (e.g. REEF2FAST.Vxi) and the frame column
+ * it holds.
+ */
+struct WaveComponent {
+    const char* filename;
+    const char* description;
+    std::vector<Value> GridFrame::* column;
+    bool transverse;    // vy, ay: zero in a 2D broadcast (SeaStateLayout::transverse_zero)
+};
+
+// The standard fields vx, vy, vz, ax, ay, az, pressure, in output order
+constexpr size_t NUM_WAVE_COMPONENTS = 7;
+extern const WaveComponent WAVE_COMPONENTS[NUM_WAVE_COMPONENTS];
+
+/**
+ * Writes all standard fields (vx, vy, vz, ax, ay, az, pressure) for the given
+ * timestep in SeaState format, one .XXX file per field.
  *
- * @param wf              Interpolated wavefield at current timestep
- * @param filename        Output filename (e.g. "REEF2FAST.Vxi")
- * @param component_name  Internal name of the field ("vx", "pressure", etc.)
- * @param description     Human-readable description for the header
- * @param accessor        Lambda to extract the relevant value from a WavefieldEntry
- * @param wave_dt         Time step in seconds
- * @param timestep        Current timestep index
- * @param append          If true, appends to existing file instead of overwriting
+ * The frame is walked once in the row order of layout; every point is
+ * formatted into all seven files in the same pass.
+ *
+ * @param writer      Buffered writer holding the open output files
+ * @param layout      Layout planned for frame's grid
+ * @param frame       Interpolated frame at current timestep
+ * @param output_dir  Directory of the .XXX files
+ * @param timestep    Current timestep index
+ * @param append      If true, appends to existing files instead of overwriting
  */
-void write_wave_component(const Wavefield& wf,
-                          const std::string& filename,
-                          const std::string& component_name,
-                          const std::string& description,
-                          std::function<double(const WavefieldEntry&)> accessor,
-                          double wave_dt,
-                          int timestep,
-                          bool append = false);
+void generate_all_wavefiles(OutputWriter& writer,
+                            const SeaStateLayout& layout,
+                            const GridFrame& frame,
+                            const std::string& output_dir,
+                            int timestep,
+                            bool append = false);
 
 /**
- * Writes all standard fields (vx, vy, vz, ax, ay, az, pressure)
- * for the given timestep in SeaState format.
+ * Header of a wave kinematics file (everything before the first timestep).
+ */
+std::string wavefile_header(const SeaStateLayout& layout, const WaveComponent& component);
+
+/**
+ * Size in bytes of one timestep of a wave kinematics file in fixed-width
+ * form. Equal for all components and all timesteps.
+ */
+size_t wavefile_block_bytes(const SeaStateLayout& layout);
+
+/**
+ * Formats one timestep of all seven wave kinematics files in fixed-width form:
+ * every value and the row time are right-aligned in MAX_SCIENTIFIC_CHARS
+ * characters, so each block is exactly wavefile_block_bytes() long.
+ *
+ * @param out  One block per entry of WAVE_COMPONENTS
  */
-void generate_all_wavefiles(const Wavefield& wf,
-                            double wave_dt,
+void format_wavefile_blocks(const SeaStateLayout& layout,
+                            const GridFrame& frame,
                             int timestep,
-                            bool append = false);
\ No newline at end of file
+                            char* const* out);
\ No newline at end of file
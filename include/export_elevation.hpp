@@ -1,16 +1,37 @@
 #pragma once
 
 #include "structs.hpp"
+#include "output_writer.hpp"
+#include "seastate_layout.hpp"
+#include <cstddef>
 #include <string>
 
 /**
  * Writes surface elevation data at z ≈ 0 (SWL) to a SeaState-compatible .Elev file.
- * Elevation values are grouped by Y, sorted by X, and include metadata header.
+ * Elevation values are grouped by Y, sorted by X (as planned in layout), and
+ * include metadata header.
  *
  * This function should be called per timestep with append = true for t > 0.
+ * path is the full path of the file (e.g. ../output/REEF2FAST.Elev).
  */
-void write_surface_elevation(const Wavefield& wf,
-                             const std::string& filename,
-                             double wave_dt,
+void write_surface_elevation(OutputWriter& writer,
+                             const SeaStateLayout& layout,
+                             const GridFrame& frame,
+                             const std::string& path,
                              int timestep,
-                             bool append);
\ No newline at end of file
+                             bool append);
+
+/**
+ * Size in bytes of one timestep of the .Elev file in fixed-width form.
+ */
+size_t elevation_block_bytes(const SeaStateLayout& layout);
+
+/**
+ * Formats one timestep of the .Elev file in fixed-width form (values and
+ * time right-aligned in MAX_SCIENTIFIC_CHARS characters), exactly
+ * elevation_block_bytes() long. The header is layout.elevation_header.
+ */
+void format_elevation_block(const SeaStateLayout& layout,
+                            const GridFrame& frame,
+                            int timestep,
+                            char* out);
\ No newline at end of file
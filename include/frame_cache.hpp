@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * One raw REEF3D row as stored in the binary frame cache.
+ * Values are kept exactly as parsed from the CSV (no z_max shift, no y-slice
+ * filtering), so a single cache serves 2D and 3D runs with any control.txt.
+ */
+struct CachedRow {
+    double vx, vy, vz;
+    double pressure;
+    double elevation;
+    double x, y, z;
+};
+
+/**
+ * Returns the cache path belonging to a wavefield CSV (e.g. "wave.csv" -> "wave.csv.r2fc").
+ */
+std::string frame_cache_path(const std::string& csv_file);
+
+/**
+ * Writes the binary frame cache while the CSV is parsed for the first time.
+ *
+ * Layout: header | rows of frame 0 | rows of frame 1 | ... | frame index.
+ * Rows are fixed-size CachedRow records, grouped per timestep in file order.
+ * The header stores size and mtime of the source CSV; the cache is only used
+ * again if both still match. The file is written under a temporary name and
+ * renamed into place by finalize(), so an interrupted run never leaves a
+ * truncated cache behind.
+ */
+class FrameCacheWriter {
+public:
+    explicit FrameCacheWriter(const std::string& csv_file);
+    ~FrameCacheWriter();
+
+    bool is_open() const { return file.is_open(); }
+
+    // Appends one row; a change of timestep starts a new frame
+    void append(int timestep, const CachedRow& row);
+
+    // Writes frame index and header and moves the cache into place
+    bool finalize();
+
+private:
+    struct FrameIndexEntry {
+        int64_t timestep;
+        uint64_t first_row;
+        uint64_t num_rows;
+    };
+
+    void close_frame();
+
+    std::string csv_file;
+    std::string final_path;
+    std::string tmp_path;
+    std::ofstream file;
+    std::vector<char> write_buffer;
+    std::vector<FrameIndexEntry> frames;
+    uint64_t rows_written;
+    int current_timestep;
+    uint64_t current_first_row;
+    bool frame_open;
+};
+
+/**
+ * Streams every frame of a valid cache to frame_fn(timestep, rows, num_rows).
+ * The cache is memory-mapped; rows point directly into the mapping.
+ *
+ * @return false (without calling frame_fn) if no cache exists or it does not
+ *         match the size/mtime of csv_file.
+ */
+bool read_frame_cache(const std::string& csv_file,
+                      const std::function<void(int, const CachedRow*, size_t)>& frame_fn);
@@ -32,10 +32,12 @@ bool read_wave_parameters(const std::string& filename,
  * @param wave_dt        Wave time step
  * @param wave_hs        Significant wave height
  * @param wave_tp        Peak spectral period
+ * @param output_dir     Directory the file is written to
  */
 void generate_seastate(double X_MIN, double X_MAX,
                        double Y_MIN, double Y_MAX,
                        double Z_MIN, double Z_MAX,
                        int NX, int NY, int NZ,
                        double sim_time, double wave_dt,
-                       double wave_hs, double wave_tp);
\ No newline at end of file
+                       double wave_hs, double wave_tp,
+                       const std::string& output_dir = "../output");
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "spatial_index.hpp"
+#include <cstddef>
+
+/**
+ * Vectorized inverse-distance weighting.
+ *
+ * Inputs are structure-of-arrays blocks of gathered neighbours: slot j of
+ * target i is at [j * n + i], so one SIMD lane handles one target point.
+ * Weights are w = 1 / (sqrt(d) + 1e-6) with d the squared distance; unused
+ * slots carry d = +inf and value 0, which contributes exactly nothing.
+ *
+ * Tolerance: each lane sums its neighbours in slot order with correctly
+ * rounded sqrt/div and without FMA contraction, i.e. the same operation
+ * sequence as the scalar loop. Results are bit-identical to it (0 ulp).
+ *
+ * Uses AVX2 (4 targets per instruction) when the CPU supports it, SSE2 (2)
+ * otherwise, and a scalar loop on non-x86 builds.
+ */
+namespace idw {
+
+constexpr int MAX_FIELDS = 8;
+
+/**
+ * Computes out[f][i] = sum_j w_ij * values[f][j*n + i] / sum_j w_ij.
+ *
+ * @param n           Number of target points in the block
+ * @param k           Neighbour slots per target
+ * @param dists       Squared distances, k*n entries in SoA layout
+ * @param values      num_fields arrays of k*n gathered values (SoA)
+ * @param num_fields  Number of fields, at most MAX_FIELDS
+ * @param out         num_fields arrays of n results
+ */
+void kernel(size_t n, int k,
+            const double* dists,
+            const double* const* values,
+            int num_fields,
+            double* const* out);
+
+/**
+ * Interpolates per-source value columns onto the targets of a neighbour list:
+ * out[f][i] = IDW of columns[f][neighbour indices of target i].
+ * Gathers blocks of targets into SoA form and runs kernel() on them (OpenMP).
+ * Columns are stored as Value; the gather widens them to double, so weights
+ * and sums are always computed in double precision.
+ */
+void interpolate(const NeighbourList& neighbours,
+                 const Value* const* columns,
+                 int num_fields,
+                 Value* const* out);
+
+// Name of the instruction set kernel() dispatches to ("avx2", "sse2", "scalar")
+const char* kernel_isa();
+
+} // namespace idw
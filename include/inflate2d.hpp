@@ -1,15 +1,16 @@
 #pragma once
 
-#include "structs.hpp"
+#include <vector>
 
 /**
- * Inflates a 2D wavefield into a 3D wavefield by duplicating it along the y-axis.
+ * y-positions of the slices a 2D wavefield is broadcast to for export.
  *
- * The duplicated slices are centered between -Y_total/2 and Y_total/2 and spaced equally.
+ * The slices are centered between -Y_total/2 and Y_total/2 and spaced equally.
  * This produces NY-1 slices in total, as expected by OpenFAST's SeaState format.
+ * Every slice holds the 2D frame unchanged; the export repeats it per slice
+ * (see plan_seastate_layout_y_broadcast) instead of copying the frame.
  *
- * @param wf       The 2D wavefield to be expanded in-place
  * @param Y_total  Full span in y-direction
  * @param NY       Total number of y-grid points
  */
-void inflate_wavefield_y(Wavefield& wf, double Y_total, int NY);
\ No newline at end of file
+std::vector<double> inflate_slices_y(double Y_total, int NY);
\ No newline at end of file
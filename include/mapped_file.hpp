@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * Read-only memory mapping of a whole file (POSIX mmap).
+ * The mapping is released when the object goes out of scope.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path) { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Maps the file; returns false if it cannot be opened or mapped
+    bool open(const std::string& path);
+    void close();
+
+    bool is_open() const { return data_ != nullptr; }
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    // Hint to the kernel that the mapping is read front to back
+    void advise_sequential() const;
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * Buffered writer for the output files of a run (SeaState files, .Elev, CSV).
+ *
+ * Every file is opened once, on first use, and stays open until close().
+ * Callers format text into the file's buffer(); commit() hands every buffer
+ * that has grown beyond flush_bytes to a background thread, which writes it
+ * with plain write() calls in submission order. At most max_pending_bytes
+ * wait for the flush thread, commit() blocks beyond that.
+ *
+ * Only one thread may call buffer(), commit() and close().
+ */
+class OutputWriter {
+public:
+    explicit OutputWriter(size_t flush_bytes = 4u << 20, size_t max_pending_bytes = 64u << 20);
+    ~OutputWriter();
+
+    OutputWriter(const OutputWriter&) = delete;
+    OutputWriter& operator=(const OutputWriter&) = delete;
+
+    /**
+     * Text buffer of the file at path. The file is opened on first use:
+     * truncated unless append is set. Returns nullptr if it cannot be opened.
+     */
+    std::string* buffer(const std::string& path, bool append);
+
+    // Hands full buffers to the flush thread; rethrows an earlier write error
+    void commit();
+
+    // Writes all buffers, waits for the flush thread and closes every file.
+    // Throws std::runtime_error if a write failed.
+    void close();
+
+private:
+    struct OutputFile {
+        int fd;
+        std::string path;
+        std::string text;
+    };
+
+    struct Block {
+        OutputFile* file;
+        std::string text;
+    };
+
+    void submit(OutputFile& file);
+    void flush_loop();
+
+    size_t flush_bytes;
+    size_t max_pending_bytes;
+    std::map<std::string, std::unique_ptr<OutputFile>> files;
+
+    // Hand-over to the flush thread
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<Block> blocks;
+    size_t pending_bytes;
+    bool stopping;
+    std::exception_ptr write_error;
+    std::thread flusher;
+};
\ No newline at end of file
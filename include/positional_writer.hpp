@@ -0,0 +1,82 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Parallel writer for output files made of a header and fixed-size blocks
+ * (one block per timestep, see format_wavefile_blocks()).
+ *
+ * Block i of a file starts at header size + i * block size, so blocks do not
+ * depend on each other: submit() queues the formatting of block i of every
+ * file, and a pool of threads formats blocks and pwrite()s them straight to
+ * their offsets, in any order. close() trims the files to the blocks written.
+ *
+ * Only one thread may call add_file(), reserve(), submit() and close(); all
+ * files must be added before the first submit().
+ */
+class PositionalWriter {
+public:
+    // Fills one block per added file (in order of add_file()); runs on a pool thread
+    using FormatFn = std::function<void(char* const* blocks)>;
+
+    PositionalWriter(int num_threads, size_t max_queued_blocks);
+    ~PositionalWriter();
+
+    PositionalWriter(const PositionalWriter&) = delete;
+    PositionalWriter& operator=(const PositionalWriter&) = delete;
+
+    /**
+     * Creates (truncates) the file at path and writes its header. If the file
+     * cannot be opened, false is returned and its blocks are formatted but
+     * not written.
+     */
+    bool add_file(const std::string& path, const std::string& header, size_t block_bytes);
+
+    // Preallocates num_blocks blocks of every file (a hint; may do nothing)
+    void reserve(size_t num_blocks);
+
+    // Queues block index of every file; blocks while max_queued_blocks are
+    // pending. Rethrows an earlier write error.
+    void submit(size_t index, FormatFn format);
+
+    // Waits for all blocks, trims every file after the last block and closes it.
+    // Throws std::runtime_error if a write failed.
+    void close();
+
+private:
+    struct OutputFile {
+        int fd;
+        std::string path;
+        size_t header_bytes;
+        size_t block_bytes;
+    };
+
+    struct Job {
+        size_t index;
+        FormatFn format;
+    };
+
+    void work();
+    void fail(const std::string& what);
+
+    std::vector<OutputFile> files;
+    size_t max_queued_blocks;
+    size_t num_blocks;          // highest submitted index + 1
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<Job> jobs;
+    size_t in_flight;
+    bool stopping;
+    std::exception_ptr write_error;
+    int num_threads;
+    std::vector<std::thread> threads;
+};
\ No newline at end of file
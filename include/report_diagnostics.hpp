@@ -8,8 +8,8 @@
  * Reports per-timestep max values of velocity, acceleration, pressure and elevation.
  * Used for diagnostics and debugging.
  */
-void report_diagnostics_3d(const Wavefield& wf, int timestep);
-void report_diagnostics_2d(const Wavefield& wf, int timestep);
+void report_diagnostics_3d(const GridFrame& frame, int timestep);
+void report_diagnostics_2d(const GridFrame& frame, int timestep);
 
 /**
  * Reports a summary of the REEF3D and SeaState grids.
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+/**
+ * Allocation-free "%.4e" formatting for the SeaState output files.
+ *
+ * The text is byte-for-byte what std::ostream prints with std::scientific and
+ * std::setprecision(4) (e.g. "-1.2345e-01", "0.0000e+00", "nan"), i.e. the
+ * value correctly rounded to 5 significant digits.
+ */
+
+// Upper bound of the characters written for one value ("-2.2251e-308")
+constexpr size_t MAX_SCIENTIFIC_CHARS = 12;
+
+/**
+ * Writes value to out (at least MAX_SCIENTIFIC_CHARS available) and returns
+ * the end of the text. No terminating zero is written.
+ */
+char* write_scientific(char* out, double value);
+
+/**
+ * Appends values[0..n) to out, each followed by a single space (one SeaState row).
+ */
+template <typename T>
+void append_scientific_row(std::string& out, const T* values, size_t n) {
+    const size_t begin = out.size();
+    out.resize(begin + n * (MAX_SCIENTIFIC_CHARS + 1));
+
+    char* p = &out[begin];
+    for (size_t i = 0; i < n; ++i) {
+        p = write_scientific(p, static_cast<double>(values[i]));
+        *p++ = ' ';
+    }
+    out.resize(static_cast<size_t>(p - out.data()));
+}
+
+// Appends a single value to out (no separator)
+inline void append_scientific(std::string& out, double value) {
+    char buf[MAX_SCIENTIFIC_CHARS];
+    out.append(buf, write_scientific(buf, value));
+}
+
+/**
+ * Writes value right-aligned in exactly MAX_SCIENTIFIC_CHARS characters and
+ * returns the end of the field. Used where every row must have a fixed width.
+ */
+inline char* write_scientific_padded(char* out, double value) {
+    char buf[MAX_SCIENTIFIC_CHARS];
+    const size_t n = static_cast<size_t>(write_scientific(buf, value) - buf);
+    const size_t pad = MAX_SCIENTIFIC_CHARS - n;
+    std::memset(out, ' ', pad);
+    std::memcpy(out + pad, buf, n);
+    return out + MAX_SCIENTIFIC_CHARS;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "structs.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * Row layout of the SeaState output files for one grid geometry.
+ *
+ * The target grid never changes during a run, so everything the export needs
+ * besides the values themselves is planned once: the order in which grid
+ * points appear in the kinematics files (.Vxi ... .DynP), the surface points
+ * of the .Elev file, and both headers. Per timestep the export then only
+ * gathers values along these index lists.
+ *
+ * Value rows are lists of grid indices; output rows are the lines of a
+ * timestep, each printing one value row. In 3D every value row is printed
+ * once. A 2D grid is broadcast along y: each value row is printed once per
+ * y-slice, so the export formats it once and repeats the text.
+ */
+struct SeaStateLayout {
+    const GridGeometry* grid = nullptr;
+    double wave_dt = 0.0;
+
+    // 2D broadcast: vy and ay are zero, their rows are a constant line
+    bool transverse_zero = false;
+    std::string zero_row;                // "0.0000e+00 " per point of the longest row
+    std::string zero_row_padded;         // same, values right-aligned (fixed-width form)
+
+    // Kinematics files: output rows ordered by (z, y), points of a row in grid order.
+    // Value row v holds the grid indices order[row_begin[v] .. row_begin[v + 1]).
+    bool kinematics_valid = false;       // at least two distinct x, y and z
+    std::string kinematics_header;       // header lines after the description
+    std::vector<size_t> order;
+    std::vector<size_t> row_begin;
+    std::vector<size_t> row_source;      // value row of each output row
+    std::vector<std::string> row_label;  // "! All X values at Y = ..., Z = ..., Time = "
+
+    // .Elev file: surface points (z = 0) by y, sorted by x within a row.
+    // Value row v holds the grid indices surface_order[surface_row_begin[v] .. surface_row_begin[v + 1]).
+    bool elevation_valid = false;        // at least two distinct surface x and y
+    std::string elevation_header;
+    std::vector<size_t> surface_order;
+    std::vector<size_t> surface_row_begin;
+    std::vector<size_t> surface_row_source;
+    std::vector<std::string> surface_row_label;  // "! Y = ..., Time = "
+
+    size_t rows() const { return row_label.size(); }
+    size_t surface_rows() const { return surface_row_label.size(); }
+};
+
+/**
+ * Plans the SeaState layout of a 3D grid (which must outlive the layout).
+ *
+ * @param grid     Geometry of the exported frames
+ * @param wave_dt  Time step in seconds, written to the headers
+ */
+SeaStateLayout plan_seastate_layout(const GridGeometry& grid, double wave_dt);
+
+/**
+ * Plans the SeaState layout of a 2D grid broadcast to the given y-slices
+ * (see inflate_slices_y): the same files as for the grid copied once per
+ * slice, without materializing the copies. The y-coordinates of grid are
+ * ignored, vy and ay are written as zero.
+ *
+ * @param grid      Geometry of the exported 2D frames
+ * @param y_slices  y-position of every slice, ascending
+ * @param wave_dt   Time step in seconds, written to the headers
+ */
+SeaStateLayout plan_seastate_layout_y_broadcast(const GridGeometry& grid,
+                                                const std::vector<double>& y_slices,
+                                                double wave_dt);
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "structs.hpp"
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * k nearest raw points of every target point, as returned by SpatialIndex.
+ * Target i owns the slots [i*k, i*k + count[i]); dists are squared distances
+ * in ascending order.
+ */
+struct NeighbourList {
+    int k = 0;
+    std::vector<size_t> indices;
+    std::vector<double> dists;
+    std::vector<int> count;
+
+    size_t num_targets() const { return count.size(); }
+};
+
+/**
+ * KD-tree over the raw REEF3D points that is kept alive across timesteps.
+ *
+ * Every call compares the incoming coordinates with the ones the index was
+ * built from:
+ *  - unchanged (static grid): tree and target neighbour lists are reused,
+ *    no build and no kNN query is done;
+ *  - a subset moved: the moved points go into a small overlay tree and are
+ *    masked out of the base tree, only the kNN queries are repeated;
+ *  - too many points moved or the point count changed: full rebuild.
+ *
+ * dims = 3 indexes (x, y, z); dims = 2 indexes the (x, z) plane of a 2D case.
+ */
+class SpatialIndex {
+public:
+    static constexpr int MAX_NEIGHBOURS = 64;
+
+    // k must be in [1, MAX_NEIGHBOURS]
+    SpatialIndex(int dims, int k);
+    ~SpatialIndex();
+
+    SpatialIndex(const SpatialIndex&) = delete;
+    SpatialIndex& operator=(const SpatialIndex&) = delete;
+
+    /**
+     * Updates the index to the coordinates of raw and returns the k nearest raw
+     * points of every target. The reference stays valid until the next call.
+     */
+    const NeighbourList& query(const Wavefield& raw,
+                               const std::vector<std::array<double, 3>>& targets);
+
+    /**
+     * Updates the index to raw like query() and writes the k nearest raw points
+     * of other targets to out, e.g. a few moved query points. The neighbour
+     * list of query() stays cached as long as raw does not move.
+     */
+    void search(const Wavefield& raw,
+                const std::vector<std::array<double, 3>>& targets,
+                NeighbourList& out);
+
+    // How often query() rebuilt, partially updated or reused the index
+    size_t num_rebuilds() const { return rebuilds; }
+    size_t num_partial_updates() const { return partial_updates; }
+    size_t num_reused() const { return reused; }
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+
+    size_t rebuilds;
+    size_t partial_updates;
+    size_t reused;
+};
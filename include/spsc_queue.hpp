@@ -0,0 +1,98 @@
+#pragma once
+
+#include "trace.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Bounded lock-free queue between exactly one producer and one consumer thread.
+ *
+ * Head and tail are plain atomic counters on separate cache lines; a full or
+ * empty queue is waited on by spinning with yield, then short sleeps. Either
+ * side can close() the queue: the producer after its last item (the consumer
+ * drains the rest), the consumer to cancel (push() then fails). Each side
+ * counts the time it spent blocked, for the stage timings of the pipeline.
+ */
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity)
+        : slots(capacity + 1), head(0), tail(0), closed(false), push_waited(0.0), pop_waited(0.0) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Blocks while the queue is full; returns false if it was closed
+    bool push(T item) {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        const size_t next = advance(t);
+
+        if (next == head.load(std::memory_order_acquire)) {
+            TRACE_SPAN("queue full");
+            const auto start = Clock::now();
+            unsigned spins = 0;
+            while (next == head.load(std::memory_order_acquire) && !closed.load(std::memory_order_acquire)) {
+                backoff(spins);
+            }
+            push_waited += std::chrono::duration<double>(Clock::now() - start).count();
+        }
+        if (closed.load(std::memory_order_acquire)) return false;
+
+        slots[t] = std::move(item);
+        tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Blocks while the queue is empty; returns false once it is closed and drained
+    bool pop(T& item) {
+        const size_t h = head.load(std::memory_order_relaxed);
+
+        if (h == tail.load(std::memory_order_acquire)) {
+            TRACE_SPAN("queue empty");
+            const auto start = Clock::now();
+            unsigned spins = 0;
+            while (h == tail.load(std::memory_order_acquire) && !closed.load(std::memory_order_acquire)) {
+                backoff(spins);
+            }
+            pop_waited += std::chrono::duration<double>(Clock::now() - start).count();
+
+            // Re-check: the producer may have pushed right before closing
+            if (h == tail.load(std::memory_order_acquire)) return false;
+        }
+
+        item = std::move(slots[h]);
+        slots[h] = T();  // release the slot's resources early
+        head.store(advance(h), std::memory_order_release);
+        return true;
+    }
+
+    void close() { closed.store(true, std::memory_order_release); }
+
+    // Seconds push() waited for space (read by the producer or after it finished)
+    double push_wait_seconds() const { return push_waited; }
+
+    // Seconds pop() waited for an item (read by the consumer or after it finished)
+    double pop_wait_seconds() const { return pop_waited; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    size_t advance(size_t i) const { return (i + 1 == slots.size()) ? 0 : i + 1; }
+
+    static void backoff(unsigned& spins) {
+        if (++spins < 64) std::this_thread::yield();
+        else std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
+    std::vector<T> slots;
+    alignas(64) std::atomic<size_t> head;   // next slot to pop (consumer)
+    alignas(64) std::atomic<size_t> tail;   // next slot to push (producer)
+    alignas(64) std::atomic<bool> closed;
+    alignas(64) double push_waited;         // producer only
+    alignas(64) double pop_waited;          // consumer only
+};
\ No newline at end of file
@@ -3,9 +3,23 @@
 #ifndef STREAMINGPIPELINE_HPP
 #define STREAMINGPIPELINE_HPP
 
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include "structs.hpp"
+#include "wavefield_streaming.hpp"
+#include "acc.hpp"
+#include "spatial_index.hpp"
+#include "surface_elevation.hpp"
+#include "output_writer.hpp"
+#include "positional_writer.hpp"
+#include "seastate_layout.hpp"
+
+template <typename T> class SpscQueue;
 
 class StreamingPipeline {
 public:
@@ -17,15 +31,86 @@ public:
                       bool write_csv,
                       double y_total,
                       int ny_usr,
-                      bool use_wheeler);
+                      bool use_wheeler,
+                      bool use_frame_cache,
+                      int timestep_workers = 1,
+                      int export_threads = 0,
+                      int acceleration_order = 2,
+                      const std::string& output_dir = "../output");
 
+    // Runs reader, compute and writer as three overlapping stages
     void run();
+
+    // Wall time of the stages of the last run(). The stages overlap, so they
+    // do not add up to total; time a stage waited on its neighbours is not
+    // counted.
+    struct StageTimes {
+        double ingest = 0.0;     // reader: CSV parsing and frame hand-over
+        double compute = 0.0;    // interpolation, acceleration, elevation, diagnostics
+        double write = 0.0;      // SeaState/CSV formatting and file output
+        double total = 0.0;
+        int timesteps = 0;
+    };
+    const StageTimes& stage_times() const { return times; }
+
+    // Computes and writes one timestep in the calling thread
     void process_timestep(int timestep,
                           const std::vector<WavefieldEntry>& prev,
                           const std::vector<WavefieldEntry>& curr,
                           const std::vector<WavefieldEntry>& next);
 
 private:
+    // Compute stage: interpolation with acceleration, Wheeler stretching and
+    // elevation; returns the frame to export
+    GridFrame compute_timestep(int timestep, const AccelerationFrames& frames);
+
+    // Stage hand-over records (defined in streamingpipeline.cpp)
+    struct RawWindow;
+    struct ExportJob;
+
+    // Raw frames of a window as the acceleration stencil sees them
+    static AccelerationFrames stencil_frames(const RawWindow& window);
+
+    // Compute stage, one timestep after the other
+    void compute_timesteps(SpscQueue<RawWindow>& raw_queue, SpscQueue<ExportJob>& export_queue);
+
+    // Compute stage with timestep_workers frames in flight and an ordered commit
+    void compute_timesteps_parallel(SpscQueue<RawWindow>& raw_queue, SpscQueue<ExportJob>& export_queue);
+
+    // Per-window part of the compute stage: the frame as written for timestep
+    // curr (Wheeler-stretched if enabled) with acceleration and surface
+    // elevation. index is updated to curr
+    GridFrame compute_frame(int timestep, const AccelerationFrames& frames, SpatialIndex& index) const;
+
+    // Fields of curr and their acceleration differenced at the fixed target
+    // points, for raw points that move between frames (NHFLOW's sigma grid)
+    void interpolate_at_targets(int timestep,
+                                const AccelerationFrames& frames,
+                                SpatialIndex& index,
+                                GridFrame& frame) const;
+
+    // Interpolated fields of a frame (vy only in 3D)
+    unsigned interpolated_fields() const;
+
+    // Re-samples the targets that Wheeler stretching maps above SWL
+    void apply_wheeler(const std::vector<WavefieldEntry>& curr,
+                       SpatialIndex& index,
+                       GridFrame& frame) const;
+
+    // Ordered part of the compute stage: diagnostics.
+    // frame becomes the returned frame (moved from)
+    GridFrame finish_timestep(int timestep, GridFrame& frame);
+
+    // Writer stage: appends one exported frame to the SeaState files, or hands
+    // it to the positional writer
+    void write_timestep(int timestep, GridFrame frame);
+
+    // Creates the SeaState files for positional writes (export_threads > 0)
+    void open_positional_output();
+
+    void stream_raw_frames(const SharedFrameCallback& callback);
+
+
     // Input
     std::string wavefield_file;
     std::string control_file;
@@ -38,12 +123,20 @@ private:
     double y_total;
     int ny_usr;
     bool use_wheeler;
+    bool use_frame_cache;
+    int timestep_workers;           // frames computed concurrently (1 = sequential)
+    int export_threads;             // positional SeaState writers (0 = serial appender)
+    int acceleration_order;         // 2 = three-point, 4 = five-point central difference
+    std::string output_dir;         // SeaState files, REEF2FAST.dat and the CSV export
 
     // Grid
     double X_MIN, X_MAX, Y_MIN, Y_MAX, Z_MIN, Z_MAX;
     int NX, NY, NZ;
     double z_max;
     std::vector<std::array<double, 3>> target_grid;
+    GridGeometry grid;              // target_grid as columns, shared by all frames
+    std::vector<double> y_slices;   // 2D only: y of the slices the export repeats the grid at
+    SeaStateLayout seastate_layout; // SeaState row order of the exported geometry
 
     // Time
     double wave_dt;
@@ -53,6 +146,41 @@ private:
     bool grid_reported;
     bool seastate_written;
     bool first_elevation_written;
+
+    // KD-tree over the raw frames, kept across timesteps
+    SpatialIndex raw_index;
+
+    // Raw frames interpolated to the target points (unstretched), by frame
+    // index of the stream. Every frame is interpolated once for the up to five
+    // timesteps whose acceleration stencil reads it; the first timestep that
+    // needs a frame interpolates it, the others wait for the result.
+    class TargetFrames {
+    public:
+        std::shared_future<GridFrame> get(int frame, const std::function<GridFrame()>& interpolate);
+        void drop_before(int frame);   // frames no later timestep reads
+        void clear();
+
+    private:
+        std::mutex mutex;
+        std::map<int, std::shared_future<GridFrame>> frames;
+    };
+    mutable TargetFrames target_frames;
+
+    // Column plan of the surface elevation, shared by all compute threads
+    SurfaceElevation surface_elevation;
+    SurfaceElevation wheeler_surface;   // REEF3D elevation for the Wheeler inverse map
+
+    // Output files, open for the whole run (used by the writer stage only)
+    OutputWriter output;
+    std::unique_ptr<PositionalWriter> positional;  // SeaState files if export_threads > 0
+    bool positional_wavefiles;      // which files the positional blocks hold
+    bool positional_elevation;
+    size_t blocks_submitted;        // block index of the next exported frame
+
+    // Index statistics of all indices used by run()
+    size_t index_rebuilds, index_partial_updates, index_reused;
+
+    StageTimes times;
 };
 
 #endif // STREAMINGPIPELINE_HPP
\ No newline at end of file
@@ -3,24 +3,59 @@
 #include <vector>
 #include <array>
 #include <cmath>
+#include <cstddef>
 
 /**
- * Represents a single wavefield data point (interpolated or raw).
- * Includes velocity, pressure, elevation and (optional) acceleration.
+ * Storage type of kinematic values (velocity, pressure, elevation, acceleration).
+ * Configuring with -DREEF2FAST_FLOAT_VALUES=ON stores them in single precision;
+ * coordinates and all accumulations (IDW sums, differences) stay in double.
+ */
+#ifdef REEF2FAST_FLOAT_VALUES
+using Value = float;
+#else
+using Value = double;
+#endif
+
+/**
+ * Represents a single raw REEF3D data point.
+ * Includes velocity, pressure and elevation. The NHFLOW grid moves with the
+ * free surface, so every raw point carries its own position.
  */
 struct WavefieldEntry {
     double x, y, z;             // Position (in meters)
-    double vx, vy, vz;          // Velocity components (m/s)
-    double pressure;            // Dynamic pressure (Pa)
-    double elevation;           // Surface elevation (m relative to SWL)
-
-    // Acceleration (computed post-interpolation)
-    double ax = NAN;
-    double ay = NAN;
-    double az = NAN;
+    Value vx, vy, vz;           // Velocity components (m/s)
+    Value pressure;             // Dynamic pressure (Pa)
+    Value elevation;            // Surface elevation (m relative to SWL)
+};
+
+/**
+ * Represents a complete raw wavefield at a single timestep.
+ */
+using Wavefield = std::vector<WavefieldEntry>;
+
+/**
+ * Geometry of the SeaState target grid, stored once for all timesteps.
+ * Point i is (x[i], y[i], z[i]).
+ */
+struct GridGeometry {
+    std::vector<double> x, y, z;
+
+    size_t size() const { return x.size(); }
 };
 
 /**
- * Represents a complete wavefield at a single timestep.
+ * Values of one timestep on a GridGeometry, one contiguous column per quantity.
+ * A column that has not been computed yet is empty; an empty vx column marks a
+ * missing frame (e.g. no successor at the last timestep).
  */
-using Wavefield = std::vector<WavefieldEntry>;
\ No newline at end of file
+struct GridFrame {
+    const GridGeometry* grid = nullptr;
+
+    std::vector<Value> vx, vy, vz;    // Velocity components (m/s)
+    std::vector<Value> pressure;      // Dynamic pressure (Pa)
+    std::vector<Value> elevation;     // Surface elevation (m relative to SWL)
+    std::vector<Value> ax, ay, az;    // Acceleration (computed post-interpolation)
+
+    size_t size() const { return vx.size(); }
+    bool empty() const { return vx.empty(); }
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "structs.hpp"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * Surface elevation of the interpolated frames, evaluated per vertical column.
+ *
+ * The raw REEF3D points are grouped into columns of equal (x, y) (x alone in
+ * a 2D case, where y is constant); a column's surface is its highest z
+ * ("geometric" mode "z") or its highest REEF3D elevation (mode "e"). The
+ * column surfaces are interpolated with IDW over their 4 nearest columns and
+ * every target point gets the value of its own (x, y).
+ *
+ * Elevation only depends on (x, y), so all geometry is planned once and
+ * reused while the raw x, y and the target grid stay the same: the raw
+ * points of every column, the unique target columns and their neighbour
+ * columns. Per frame only the column maxima (in parallel, one column per
+ * iteration), one IDW evaluation per target column and the broadcast down
+ * the vertical remain.
+ */
+class SurfaceElevation {
+public:
+    enum class Source {
+        GEOMETRIC,   // highest z of a column
+        REEF3D       // highest REEF3D elevation of a column
+    };
+
+    // dims = 2: columns keyed by (x, y); dims = 1: by x (2D case)
+    SurfaceElevation(int dims, Source source);
+    ~SurfaceElevation();
+
+    SurfaceElevation(const SurfaceElevation&) = delete;
+    SurfaceElevation& operator=(const SurfaceElevation&) = delete;
+
+    /**
+     * Fills target.elevation from the raw frame at the same timestep.
+     * Safe to call from several threads at once (the plan is shared).
+     */
+    void compute(GridFrame& target, const Wavefield& raw) const;
+
+    // Same for the points of grid, written to out
+    void evaluate(const GridGeometry& grid, const Wavefield& raw, std::vector<Value>& out) const;
+
+    // How often the column plan was built
+    size_t num_plans() const;
+
+private:
+    struct Plan;
+
+    // Plan matching raw and grid, built if the current one does not
+    std::shared_ptr<const Plan> plan_for(const Wavefield& raw, const GridGeometry& grid) const;
+
+    int dims;
+    Source source;
+
+    mutable std::mutex mutex;
+    mutable std::shared_ptr<const Plan> plan;
+    mutable size_t plans_built;
+};
\ No newline at end of file
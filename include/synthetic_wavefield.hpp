@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * Synthetic REEF3D::NHFLOW wavefields for benchmarks and verification runs.
+ *
+ * A regular wave is evaluated on a sigma grid that follows the free surface,
+ * as in NHFLOW's output, and written in the column layout of the REEF3D CSV
+ * export read by stream_wavefield_with_context():
+ *
+ *   timestep,u,v,w,pressure,elevation,x,y,z
+ *
+ * with z and elevation in the REEF3D vertical system (bed at the z_min of
+ * control.txt, still-water level at its z_max).
+ */
+
+// Wave theory of a SyntheticWave
+enum class WaveTheory {
+    AIRY,       // linear
+    STOKES2     // second-order Stokes (bound second harmonic, linear dispersion)
+};
+
+// "airy" / "stokes2"; parse_wave_theory throws std::invalid_argument for other names
+const char* wave_theory_name(WaveTheory theory);
+WaveTheory parse_wave_theory(const std::string& name);
+
+/**
+ * Regular wave in finite depth, of linear (Airy) or second-order Stokes theory
+ * (Dean & Dalrymple). Kinematics are given relative to the still-water level;
+ * above it the profiles are extrapolated, as the raw NHFLOW points up to the
+ * crest need values. Pressures are dynamic (total pressure + rho g z).
+ */
+class SyntheticWave {
+public:
+    // height H (m), period T (s), still-water depth h (m), direction from +x (rad)
+    SyntheticWave(double height, double period, double depth, double direction = 0.0,
+                  WaveTheory theory = WaveTheory::AIRY);
+
+    // Wave number from the linear dispersion relation ω² = g k tanh(k h)
+    double wave_number() const { return k; }
+    WaveTheory wave_theory() const { return theory; }
+
+    // Surface elevation above SWL at (x, y) and time t
+    double elevation(double x, double y, double t) const;
+
+    // Velocity and dynamic pressure at (x, y, z), z relative to SWL
+    void kinematics(double x, double y, double z, double t,
+                    double& u, double& v, double& w, double& pressure) const;
+
+    // Local acceleration (∂u/∂t at the fixed point) at (x, y, z)
+    void acceleration(double x, double y, double z, double t,
+                      double& ax, double& ay, double& az) const;
+
+private:
+    double phase(double x, double y, double t) const;
+
+    double amplitude, omega, depth, k;
+    double cos_dir, sin_dir;
+    WaveTheory theory;
+    // Velocity amplitude of the n-th harmonic (u = Σ A_n cosh(n k (z + h)) cos nθ)
+    double harmonic[2];
+    double second_elevation;      // amplitude of the cos 2θ elevation term
+};
+
+/**
+ * Raw NHFLOW grid: nx × ny node columns over the horizontal domain, nz nodes
+ * per column from the bed to the free surface. A 2D grid has two node rows in
+ * y (the two sides of NHFLOW's single cell), of which the pipeline reads one.
+ */
+struct SyntheticGrid {
+    double x_min = 0.0, x_max = 0.0, y_min = 0.0, y_max = 0.0;
+    double z_min = 0.0, z_max = 0.0;    // bed and still-water level
+    int nx = 2, ny = 2, nz = 2;
+    bool is2D = false;
+
+    size_t points() const { return static_cast<size_t>(nx) * ny * nz; }
+};
+
+/**
+ * Raw grid over the domain of control.txt with refine raw cells per SeaState
+ * cell in every direction (refine = 2 matches NHFLOW's usual output density).
+ * Throws std::runtime_error if control.txt cannot be read.
+ */
+SyntheticGrid synthetic_grid_from_control(const std::string& control_file, double refine);
+
+/**
+ * Writes num_timesteps frames (t = 0, dt, 2 dt, ...) of wave on grid as a
+ * REEF3D CSV. Returns the number of rows written; throws std::runtime_error
+ * if the file cannot be written.
+ */
+size_t write_synthetic_wavefield(const std::string& path,
+                                 const SyntheticWave& wave,
+                                 const SyntheticGrid& grid,
+                                 int num_timesteps,
+                                 double dt);
\ No newline at end of file
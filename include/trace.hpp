@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Scoped trace spans, written as Chrome trace-event JSON (chrome://tracing,
+ * ui.perfetto.dev): one row per thread with the stages it ran and their
+ * timesteps, so a run shows its critical path and the load balance of the
+ * OpenMP loops.
+ *
+ * Spans are only compiled in with -DREEF2FAST_TRACE=ON. Otherwise TRACE_SPAN
+ * and TRACE_THREAD_NAME expand to nothing and their arguments are not
+ * evaluated. A tracing build records between trace_start() and trace_stop().
+ */
+
+#ifdef REEF2FAST_TRACE
+constexpr bool TRACE_BUILD = true;
+#else
+constexpr bool TRACE_BUILD = false;
+#endif
+
+// Starts recording (drops the spans of an earlier recording)
+void trace_start();
+
+// Stops recording and writes the spans of all threads to path. Spans still
+// open on other threads are not written. Returns false if the file could not
+// be written.
+bool trace_stop(const std::string& path);
+
+// Names the calling thread in the trace (kept for later recordings)
+void trace_set_thread_name(const std::string& name);
+
+/**
+ * Span from construction to destruction on the calling thread. name must be a
+ * string literal; timestep >= 0 is shown in the span's args.
+ */
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, int timestep = -1);
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name;
+    int timestep;
+    int64_t start_ns;   // < 0 if not recording
+};
+
+#ifdef REEF2FAST_TRACE
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SPAN(...) TraceSpan TRACE_CONCAT(trace_span_, __LINE__)(__VA_ARGS__)
+#define TRACE_THREAD_NAME(name) trace_set_thread_name(name)
+#else
+#define TRACE_SPAN(...) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#endif
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "frame_cache.hpp"
+#include <cstddef>
+
+/**
+ * Zero-copy reader for REEF3D wavefield CSV files.
+ *
+ * Works on a byte range of the memory-mapped file. Each row is tokenized in
+ * place: next() only locates the nine column boundaries, the numbers are
+ * converted on demand with std::from_chars. No memory is allocated per row.
+ * The range must start at the beginning of a row.
+ *
+ * Column layout: timestep,u,v,w,pressure,elevation,x,y,z
+ *
+ * Typical use:
+ *   WavefieldCsvReader reader(begin, end);
+ *   while (reader.next()) {
+ *       if (!keep(reader.y())) continue;   // cheap pre-filter (2D slice)
+ *       reader.parse(timestep, row);
+ *   }
+ */
+class WavefieldCsvReader {
+public:
+    static constexpr int NUM_COLUMNS = 9;
+
+    WavefieldCsvReader(const char* begin, const char* end);
+
+    // Advances to the next complete row; false at end of file
+    bool next();
+
+    // Parses only the y column of the current row
+    double y() const;
+
+    // Parses all columns of the current row; false if a value is malformed
+    bool parse(int& timestep, CachedRow& row) const;
+
+    // Rows returned by next() and rows skipped as incomplete
+    size_t rows_read() const { return num_rows; }
+    size_t rows_skipped() const { return num_skipped; }
+
+private:
+    const char* cursor;
+    const char* end;
+
+    // Start of each column; field_start[NUM_COLUMNS] is the end of the line
+    const char* field_start[NUM_COLUMNS + 1];
+
+    size_t num_rows;
+    size_t num_skipped;
+};
+
+// Returns the start of the first data row (skips the header line)
+const char* skip_csv_header(const char* begin, const char* end);
+
+// Returns the start of the row containing p (p itself if it already starts a row)
+const char* align_to_row_start(const char* begin, const char* p);
+
+// Returns the start of the next row at or after p
+const char* align_to_next_row(const char* p, const char* end);
+
+/**
+ * Returns the start of the last row in [begin, end) whose timestep differs from
+ * the row before it, or nullptr if all rows in the range share one timestep.
+ * begin and end must be row boundaries.
+ */
+const char* last_timestep_boundary(const char* begin, const char* end);
@@ -2,6 +2,7 @@
 
 #include "structs.hpp"
 #include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -12,6 +13,7 @@
  * @param filename  Path to the CSV wavefield file
  * @param z_max     Maximum z-level from control.txt (used to adjust vertical reference)
  * @param callback  Function to process each timestep (prev, curr, next)
+ * @param use_frame_cache  Read from / write to the binary frame cache next to the CSV (see frame_cache.hpp)
  */
 void stream_wavefield_with_context(
     const std::string& filename,
@@ -19,7 +21,8 @@ void stream_wavefield_with_context(
     std::function<void(int t,
                        const std::vector<WavefieldEntry>& prev,
                        const std::vector<WavefieldEntry>& curr,
-                       const std::vector<WavefieldEntry>& next)> callback);
+                       const std::vector<WavefieldEntry>& next)> callback,
+    bool use_frame_cache = false);
 
 /**
  * Streams a REEF3D wavefield CSV file (2D case).
@@ -28,6 +31,7 @@ void stream_wavefield_with_context(
  * @param filename  Path to the CSV wavefield file
  * @param z_max     Maximum z-level from control.txt (used to adjust vertical reference)
  * @param callback  Function to process each timestep (prev, curr, next)
+ * @param use_frame_cache  Read from / write to the binary frame cache next to the CSV (see frame_cache.hpp)
  */
 void stream_wavefield_with_context_2d(
     const std::string& filename,
@@ -35,4 +39,37 @@ void stream_wavefield_with_context_2d(
     std::function<void(int t,
                        const std::vector<WavefieldEntry>& prev,
                        const std::vector<WavefieldEntry>& curr,
-                       const std::vector<WavefieldEntry>& next)> callback);
\ No newline at end of file
+                       const std::vector<WavefieldEntry>& next)> callback,
+    bool use_frame_cache = false);
+
+/**
+ * Complete frame of the stream, shared with its consumers. The buffer goes back
+ * to the stream's frame pool once the last holder releases it (from any thread).
+ */
+using SharedFrame = std::shared_ptr<const Wavefield>;
+
+using SharedFrameCallback = std::function<void(int t,
+                                               const SharedFrame& prev,
+                                               const SharedFrame& curr,
+                                               const SharedFrame& next)>;
+
+/**
+ * Streams a REEF3D wavefield CSV file (3D case) like stream_wavefield_with_context(),
+ * but hands out the frames themselves instead of references to the window, so a
+ * consumer can keep them without a copy. At t=0 prev and curr are the same frame;
+ * after the last timestep next is an empty frame.
+ */
+void stream_wavefield_frames(
+    const std::string& filename,
+    double z_max,
+    SharedFrameCallback callback,
+    bool use_frame_cache = false);
+
+/**
+ * 2D case of stream_wavefield_frames(): the frames hold a single y-slice.
+ */
+void stream_wavefield_frames_2d(
+    const std::string& filename,
+    double z_max,
+    SharedFrameCallback callback,
+    bool use_frame_cache = false);
\ No newline at end of file
@@ -1,5 +1,27 @@
 #pragma once
 #include "structs.hpp"
+#include <array>
+#include <cstddef>
 #include <vector>
 
-void apply_wheeler_stretching(std::vector<WavefieldEntry>& wavefield, double h);
\ No newline at end of file
+/**
+ * Wheeler stretching as an inverse map of the target points.
+ *
+ * Wheeler stretching moves the REEF3D points above SWL (z > 0) to
+ * z' = h (h + z) / (h + eta) - h, which maps the free surface z = eta onto
+ * SWL. Instead of moving every raw point, each target point z' is mapped back
+ * to z = (z' + h) (h + eta) / h - h, with eta the surface elevation at its
+ * (x, y), and the unstretched wavefield is sampled there. Only targets whose
+ * preimage lies above SWL move; the raw frame and its KD-tree stay as they are.
+ *
+ * @param targets  Target points (x, y, z)
+ * @param eta      REEF3D surface elevation at every target
+ * @param h        Water depth
+ * @param moved    Indices of the targets that move (overwritten)
+ * @param queries  Their positions in the unstretched wavefield (overwritten)
+ */
+void wheeler_inverse_targets(const std::vector<std::array<double, 3>>& targets,
+                             const std::vector<Value>& eta,
+                             double h,
+                             std::vector<size_t>& moved,
+                             std::vector<std::array<double, 3>>& queries);
\ No newline at end of file
@@ -1,18 +1,25 @@
 #pragma once
 
-#include "structs.hpp"  // For WavefieldEntry
+#include "structs.hpp"  // For GridFrame
+#include "output_writer.hpp"
+#include <string>
+#include <vector>
 
 /**
  * Writes a single timestep of the interpolated wavefield to a CSV file.
  * Each row corresponds to one point in the SeaState grid.
  *
- * @param timestep_data The current interpolated timestep data
+ * @param writer        Buffered writer holding the open output files
+ * @param frame         The current interpolated frame
  * @param filename      Output CSV path (e.g., ../output/interpolated_wavefield.csv)
  * @param timestep      Current timestep number
  * @param append        If true, appends to existing file; otherwise, overwrites
+ * @param y_slices      2D only: the frame is written once per slice, with y set to the slice
  * @return              True if file write was successful
  */
-bool write_out_csv(const std::vector<WavefieldEntry>& timestep_data,
+bool write_out_csv(OutputWriter& writer,
+                   const GridFrame& frame,
                    const std::string& filename,
                    int timestep,
-                   bool append = false);
\ No newline at end of file
+                   bool append = false,
+                   const std::vector<double>& y_slices = {});
\ No newline at end of file
@@ -1,37 +1,214 @@
 #include "acc.hpp"
 #include "structs.hpp"
+#include "cloud.hpp"
+#include "idw_kernel.hpp"
 #include <cmath>
-// fpr debudding can be deleted later
-#include <iostream>
 
 void computeAcceleration_from_context(
-    const std::vector<WavefieldEntry>& prev,
-    std::vector<WavefieldEntry>& curr,
-    const std::vector<WavefieldEntry>& next,
+    const GridFrame& prev,
+    GridFrame& curr,
+    const GridFrame& next,
     double delta_t)
 {
-    std::cout << "prev size: " << prev.size() 
-              << ", curr size: " << curr.size() 
-              << ", next size: " << next.size() << std::endl;
-
     const size_t n = curr.size();
+    curr.ax.assign(n, NAN);
+    curr.ay.assign(n, NAN);
+    curr.az.assign(n, NAN);
+
+    // At t = 0 the stream passes curr as prev: no predecessor
+    const bool has_prev = !prev.empty() && &prev != &curr;
 
     for (size_t i = 0; i < n; ++i) {
-        if (!prev.empty() && !next.empty()) {
+        if (has_prev && !next.empty()) {
             // Central difference
-            curr[i].ax = (next[i].vx - prev[i].vx) / (2.0 * delta_t);
-            curr[i].ay = (next[i].vy - prev[i].vy) / (2.0 * delta_t);
-            curr[i].az = (next[i].vz - prev[i].vz) / (2.0 * delta_t);
+            curr.ax[i] = (next.vx[i] - prev.vx[i]) / (2.0 * delta_t);
+            curr.ay[i] = (next.vy[i] - prev.vy[i]) / (2.0 * delta_t);
+            curr.az[i] = (next.vz[i] - prev.vz[i]) / (2.0 * delta_t);
         } else if (!next.empty()) {
             // Forward difference (start of simulation)
-            curr[i].ax = (next[i].vx - curr[i].vx) / delta_t;
-            curr[i].ay = (next[i].vy - curr[i].vy) / delta_t;
-            curr[i].az = (next[i].vz - curr[i].vz) / delta_t;
-        } else if (!prev.empty()) {
+            curr.ax[i] = (next.vx[i] - curr.vx[i]) / delta_t;
+            curr.ay[i] = (next.vy[i] - curr.vy[i]) / delta_t;
+            curr.az[i] = (next.vz[i] - curr.vz[i]) / delta_t;
+        } else if (has_prev) {
             // Backward difference (end of simulation)
-            curr[i].ax = (curr[i].vx - prev[i].vx) / delta_t;
-            curr[i].ay = (curr[i].vy - prev[i].vy) / delta_t;
-            curr[i].az = (curr[i].vz - prev[i].vz) / delta_t;
+            curr.ax[i] = (curr.vx[i] - prev.vx[i]) / delta_t;
+            curr.ay[i] = (curr.vy[i] - prev.vy[i]) / delta_t;
+            curr.az[i] = (curr.vz[i] - prev.vz[i]) / delta_t;
+        }
+    }
+}
+
+namespace {
+
+template <typename Frame>
+bool present(const Frame* frame) {
+    return frame && !frame->empty();
+}
+
+// Raw points read by the interpolation, in increasing order
+std::vector<size_t> referenced_sources(const NeighbourList& neighbours, size_t num_sources) {
+    std::vector<unsigned char> used(num_sources, 0);
+    const size_t n = neighbours.num_targets();
+    for (size_t t = 0; t < n; ++t) {
+        for (int j = 0; j < neighbours.count[t]; ++j) used[neighbours.indices[t * neighbours.k + j]] = 1;
+    }
+
+    std::vector<size_t> sources;
+    for (size_t s = 0; s < num_sources; ++s) {
+        if (used[s]) sources.push_back(s);
+    }
+    return sources;
+}
+
+bool same_layout(const Wavefield& a, const Wavefield& b) {
+    if (&a == &b) return true;
+    if (a.size() != b.size()) return false;
+    for (size_t s = 0; s < a.size(); ++s) {
+        if (a[s].x != b[s].x || a[s].y != b[s].y || a[s].z != b[s].z) return false;
+    }
+    return true;
+}
+
+// One stencil frame and its weight in the difference
+template <typename Frame>
+struct StencilTerm {
+    const Frame* frame;
+    double weight;
+};
+
+// Stencil weights (1/Δt included), the same cases as computeAcceleration_from_context.
+// At t = 0 the stream passes curr as prev, which counts as no predecessor, so
+// t = 0 takes the forward difference.
+// Returns the number of terms (0: single frame, no difference possible).
+template <typename Frame>
+int stencil_terms(const StencilFrames<Frame>& frames, double delta_t, int order, StencilTerm<Frame> terms[4]) {
+    const bool has_prev = present(frames.prev) && frames.prev != frames.curr;
+    const bool has_next = present(frames.next);
+
+    int num_terms = 0;
+    if (order == 4 && has_prev && has_next && present(frames.prev2) && present(frames.next2) &&
+        frames.prev2 != frames.prev && frames.next2 != frames.next) {
+        const double h = 12.0 * delta_t;
+        terms[num_terms++] = {frames.prev2, 1.0 / h};
+        terms[num_terms++] = {frames.prev, -8.0 / h};
+        terms[num_terms++] = {frames.next, 8.0 / h};
+        terms[num_terms++] = {frames.next2, -1.0 / h};
+    } else if (has_prev && has_next) {
+        terms[num_terms++] = {frames.prev, -1.0 / (2.0 * delta_t)};
+        terms[num_terms++] = {frames.next, 1.0 / (2.0 * delta_t)};
+    } else if (has_next) {
+        terms[num_terms++] = {frames.curr, -1.0 / delta_t};
+        terms[num_terms++] = {frames.next, 1.0 / delta_t};
+    } else if (has_prev) {
+        terms[num_terms++] = {frames.prev, -1.0 / delta_t};
+        terms[num_terms++] = {frames.curr, 1.0 / delta_t};
+    }
+    return num_terms;
+}
+
+} // namespace
+
+bool stencil_shares_layout(const AccelerationFrames& frames, int order) {
+    StencilTerm<Wavefield> terms[4];
+    const int num_terms = stencil_terms(frames, 1.0, order, terms);
+    for (int t = 0; t < num_terms; ++t) {
+        if (!same_layout(*frames.curr, *terms[t].frame)) return false;
+    }
+    return true;
+}
+
+bool interpolate_fields_with_acceleration(const AccelerationFrames& frames,
+                                          const NeighbourList& neighbours,
+                                          unsigned fields,
+                                          double delta_t,
+                                          int order,
+                                          GridFrame& out) {
+    const Wavefield& curr = *frames.curr;
+    StencilTerm<Wavefield> terms[4];
+    const int num_terms = stencil_terms(frames, delta_t, order, terms);
+    for (int t = 0; t < num_terms; ++t) {
+        if (!same_layout(curr, *terms[t].frame)) return false;
+    }
+
+    // Only the raw points of curr's neighbours are read, so only they are filled in
+    const std::vector<size_t> sources = referenced_sources(neighbours, curr.size());
+
+    const size_t n = neighbours.num_targets();
+    std::vector<Value> columns[idw::MAX_FIELDS];
+    const Value* column_ptrs[idw::MAX_FIELDS];
+    Value* out_ptrs[idw::MAX_FIELDS];
+    int num_fields = 0;
+
+    auto add_column = [&](std::vector<Value>& result) -> std::vector<Value>& {
+        auto& column = columns[num_fields];
+        column.resize(curr.size());
+        result.resize(n);
+        column_ptrs[num_fields] = column.data();
+        out_ptrs[num_fields] = result.data();
+        ++num_fields;
+        return column;
+    };
+
+    // Raw values of each requested field as a contiguous column (SoA)
+    auto add_field = [&](unsigned bit, Value WavefieldEntry::*member, std::vector<Value>& result) {
+        if (!(fields & bit)) return;
+        auto& column = add_column(result);
+        for (size_t s : sources) column[s] = curr[s].*member;
+    };
+
+    // Raw time difference of a velocity component at every referenced point
+    auto add_difference = [&](Value WavefieldEntry::*member, std::vector<Value>& result) {
+        auto& column = add_column(result);
+        for (size_t s : sources) {
+            double sum = 0.0;
+            for (int t = 0; t < num_terms; ++t) sum += terms[t].weight * ((*terms[t].frame)[s].*member);
+            column[s] = static_cast<Value>(sum);
         }
+    };
+
+    add_field(FIELD_VX, &WavefieldEntry::vx, out.vx);
+    add_field(FIELD_VY, &WavefieldEntry::vy, out.vy);
+    add_field(FIELD_VZ, &WavefieldEntry::vz, out.vz);
+    add_field(FIELD_PRESSURE, &WavefieldEntry::pressure, out.pressure);
+
+    if (num_terms > 0) {
+        add_difference(&WavefieldEntry::vx, out.ax);
+        if (fields & FIELD_VY) add_difference(&WavefieldEntry::vy, out.ay);
+        add_difference(&WavefieldEntry::vz, out.az);
+    } else {
+        // Single frame: no difference possible
+        out.ax.assign(n, NAN);
+        if (fields & FIELD_VY) out.ay.assign(n, NAN);
+        out.az.assign(n, NAN);
     }
-}
\ No newline at end of file
+    if (!(fields & FIELD_VY)) out.ay.assign(n, 0.0);
+
+    // Weights are computed once per target and shared by fields and accelerations
+    if (num_fields > 0) idw::interpolate(neighbours, column_ptrs, num_fields, out_ptrs);
+    return true;
+}
+
+void computeAcceleration_from_frames(const StencilFrames<GridFrame>& frames,
+                                     double delta_t,
+                                     int order,
+                                     GridFrame& out) {
+    const GridFrame& curr = *frames.curr;
+    const size_t n = curr.size();
+    StencilTerm<GridFrame> terms[4];
+    const int num_terms = stencil_terms(frames, delta_t, order, terms);
+
+    auto difference = [&](std::vector<Value> GridFrame::*member, std::vector<Value>& result) {
+        result.assign(n, NAN);
+        if (num_terms == 0) return;
+        for (size_t i = 0; i < n; ++i) {
+            double sum = 0.0;
+            for (int t = 0; t < num_terms; ++t) sum += terms[t].weight * (terms[t].frame->*member)[i];
+            result[i] = static_cast<Value>(sum);
+        }
+    };
+
+    difference(&GridFrame::vx, out.ax);
+    if (curr.vy.empty()) out.ay.assign(n, 0.0);
+    else difference(&GridFrame::vy, out.ay);
+    difference(&GridFrame::vz, out.az);
+}
@@ -3,23 +3,29 @@
 #include <cmath>
 
 void computeAcceleration2D_from_context(
-    const std::vector<WavefieldEntry>& prev,
-    std::vector<WavefieldEntry>& curr,
-    const std::vector<WavefieldEntry>& next,
+    const GridFrame& prev,
+    GridFrame& curr,
+    const GridFrame& next,
     double delta_t
 ) {
-    for (size_t i = 0; i < curr.size(); ++i) {
-        curr[i].ay = 0.0;
+    const size_t n = curr.size();
+    curr.ax.assign(n, NAN);
+    curr.ay.assign(n, 0.0);
+    curr.az.assign(n, NAN);
 
-        if (!prev.empty() && !next.empty()) {
-            curr[i].ax = (next[i].vx - prev[i].vx) / (2 * delta_t);
-            curr[i].az = (next[i].vz - prev[i].vz) / (2 * delta_t);
+    // At t = 0 the stream passes curr as prev: no predecessor
+    const bool has_prev = !prev.empty() && &prev != &curr;
+
+    for (size_t i = 0; i < n; ++i) {
+        if (has_prev && !next.empty()) {
+            curr.ax[i] = (next.vx[i] - prev.vx[i]) / (2 * delta_t);
+            curr.az[i] = (next.vz[i] - prev.vz[i]) / (2 * delta_t);
         } else if (!next.empty()) {
-            curr[i].ax = (next[i].vx - curr[i].vx) / delta_t;
-            curr[i].az = (next[i].vz - curr[i].vz) / delta_t;
-        } else if (!prev.empty()) {
-            curr[i].ax = (curr[i].vx - prev[i].vx) / delta_t;
-            curr[i].az = (curr[i].vz - prev[i].vz) / delta_t;
+            curr.ax[i] = (next.vx[i] - curr.vx[i]) / delta_t;
+            curr.az[i] = (next.vz[i] - curr.vz[i]) / delta_t;
+        } else if (has_prev) {
+            curr.ax[i] = (curr.vx[i] - prev.vx[i]) / delta_t;
+            curr.az[i] = (curr.vz[i] - prev.vz[i]) / delta_t;
         }
     }
-}
\ No newline at end of file
+}
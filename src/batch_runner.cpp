@@ -0,0 +1,272 @@
+#include "batch_runner.hpp"
+#include "common.hpp"
+#include "streamingpipeline.hpp"
+#include "trace.hpp"
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+bool parse_yes_no(const std::string& value, bool& out) {
+    if (value == "y" || value == "Y") out = true;
+    else if (value == "n" || value == "N") out = false;
+    else return false;
+    return true;
+}
+
+bool parse_int(const std::string& value, int min_value, int& out) {
+    char* end = nullptr;
+    const long v = std::strtol(value.c_str(), &end, 10);
+    if (end == value.c_str() || *end != '\0' || v < min_value) return false;
+    out = static_cast<int>(v);
+    return true;
+}
+
+// The only CSV in dir, as the interactive run finds it (without its console note)
+std::string single_csv(const fs::path& dir) {
+    std::vector<fs::path> csv_files;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".csv") csv_files.push_back(entry.path());
+    }
+    if (csv_files.empty()) throw std::runtime_error("no CSV file in " + dir.string());
+    if (csv_files.size() > 1) throw std::runtime_error("several CSV files in " + dir.string() + ", choose one with csv=");
+    return csv_files[0].string();
+}
+
+CaseSettings parse_case(const std::string& line, const fs::path& base) {
+    CaseSettings c;
+    fs::path data, csv, output;
+    bool has_y_width = false;
+
+    std::istringstream iss(line);
+    std::string item;
+    while (iss >> item) {
+        const size_t eq = item.find('=');
+        if (eq == std::string::npos || eq == 0) throw std::runtime_error("expected key=value, got '" + item + "'");
+        const std::string key = item.substr(0, eq);
+        const std::string value = item.substr(eq + 1);
+
+        bool ok = true;
+        if (key == "data") data = base / value;
+        else if (key == "csv") csv = base / value;
+        else if (key == "output") output = base / value;
+        else if (key == "name") c.name = value;
+        else if (key == "elevation") {
+            c.elevation_mode = value;
+            ok = (value == "z" || value == "e");
+        }
+        else if (key == "wheeler") ok = parse_yes_no(value, c.use_wheeler);
+        else if (key == "order") ok = parse_int(value, 2, c.acceleration_order) && (c.acceleration_order == 2 || c.acceleration_order == 4);
+        else if (key == "write_csv") ok = parse_yes_no(value, c.write_csv);
+        else if (key == "cache") ok = parse_yes_no(value, c.use_frame_cache);
+        else if (key == "workers") ok = parse_int(value, 1, c.timestep_workers);
+        else if (key == "export_threads") ok = parse_int(value, 0, c.export_threads);
+        else if (key == "threads") ok = parse_int(value, 1, c.threads);
+        else if (key == "ny") ok = parse_int(value, 4, c.ny) && c.ny % 2 == 0;
+        else if (key == "y_width") {
+            char* end = nullptr;
+            c.y_total = std::strtod(value.c_str(), &end);
+            ok = (end != value.c_str() && *end == '\0' && c.y_total > 0.0);
+            has_y_width = true;
+        }
+        else throw std::runtime_error("unknown key '" + key + "'");
+
+        if (!ok) throw std::runtime_error("invalid value for " + key + ": " + value);
+    }
+
+    if (data.empty()) throw std::runtime_error("data= is missing");
+    data = data.lexically_normal();
+    c.control_file = (data / "control.txt").string();
+    c.ctrl_file = (data / "ctrl.txt").string();
+    if (!fs::exists(c.control_file)) throw std::runtime_error("no control.txt in " + data.string());
+    if (!fs::exists(c.ctrl_file)) throw std::runtime_error("no ctrl.txt in " + data.string());
+    c.wavefield_file = csv.empty() ? single_csv(data) : csv.lexically_normal().string();
+    if (!fs::exists(c.wavefield_file)) throw std::runtime_error("no wavefield file " + c.wavefield_file);
+
+    c.output_dir = (output.empty() ? data / ".." / "output" : output).lexically_normal().string();
+    if (c.name.empty()) c.name = (output.empty() ? data.parent_path() : output.lexically_normal()).filename().string();
+
+    c.is2D = is_2D_case(c.control_file);
+    if (c.is2D && (!has_y_width || c.ny == 0)) throw std::runtime_error("2D case needs y_width= and ny=");
+    return c;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Child process: the case with stdout and stderr in its log file
+[[noreturn]] void run_case_process(const CaseSettings& c, int threads) {
+    const std::string log = c.output_dir + "/REEF2FAST.log";
+    const int fd = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd >= 0) {
+        dup2(fd, STDOUT_FILENO);
+        dup2(fd, STDERR_FILENO);
+        close(fd);
+    }
+#ifdef _OPENMP
+    omp_set_num_threads(threads);
+#else
+    (void)threads;
+#endif
+
+    int status = 0;
+    try {
+        run_case(c);
+    } catch (const std::exception& e) {
+        std::cerr << "\nPipeline failed: " << e.what() << "\n";
+        status = 1;
+    }
+    std::cout.flush();
+    std::cerr.flush();
+    _exit(status);
+}
+
+} // namespace
+
+std::vector<CaseSettings> read_case_manifest(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("Could not open case manifest " + path);
+    const fs::path base = fs::absolute(path).parent_path();
+
+    std::vector<CaseSettings> cases;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line)) {
+        ++line_number;
+        const size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+        try {
+            cases.push_back(parse_case(line, base));
+        } catch (const std::exception& e) {
+            throw std::runtime_error(path + ", line " + std::to_string(line_number) + ": " + e.what());
+        }
+    }
+    if (cases.empty()) throw std::runtime_error("No cases in " + path);
+
+    // Concurrent cases must not write to the same files
+    std::map<std::string, std::string> owners;
+    for (const CaseSettings& c : cases) {
+        auto [it, inserted] = owners.emplace(c.output_dir, c.name);
+        if (!inserted) {
+            throw std::runtime_error(path + ": cases " + it->second + " and " + c.name + " share the output folder " + c.output_dir);
+        }
+    }
+    return cases;
+}
+
+void run_case(const CaseSettings& c) {
+    StreamingPipeline pipeline(c.wavefield_file, c.control_file, c.ctrl_file, c.is2D, c.elevation_mode,
+                               c.write_csv, c.y_total, c.ny, c.use_wheeler, c.use_frame_cache,
+                               c.timestep_workers, c.export_threads, c.acceleration_order, c.output_dir);
+    if (TRACE_BUILD) trace_start();
+    pipeline.run();
+    if (TRACE_BUILD) {
+        const std::string trace_file = c.output_dir + "/REEF2FAST.trace.json";
+        if (trace_stop(trace_file)) std::cout << "\nTrace written to " << trace_file << "\n";
+        else std::cerr << "[Warning] Could not write " << trace_file << "\n";
+    }
+}
+
+// The parent only forks, waits and reports; it never starts OpenMP threads,
+// which would not survive fork()
+int run_batch(const std::vector<CaseSettings>& cases, int jobs, int thread_budget) {
+    if (thread_budget <= 0) thread_budget = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    if (jobs <= 0) jobs = thread_budget;
+    jobs = std::min(jobs, static_cast<int>(cases.size()));
+
+    std::cout << "Batch: " << cases.size() << " cases, up to " << jobs << " at a time, "
+              << thread_budget << " threads\n";
+
+    struct Running {
+        size_t index;
+        int threads;
+        std::chrono::steady_clock::time_point start;
+    };
+    std::map<pid_t, Running> running;
+    std::deque<size_t> pending;
+    for (size_t i = 0; i < cases.size(); ++i) pending.push_back(i);
+    int threads_in_use = 0;
+    int failed = 0;
+    const auto batch_start = std::chrono::steady_clock::now();
+
+    while (!pending.empty() || !running.empty()) {
+        // Start cases while job slots and threads are free; an idle batch
+        // always starts the next case, even if it asks for more than the budget
+        while (!pending.empty() && static_cast<int>(running.size()) < jobs) {
+            const CaseSettings& c = cases[pending.front()];
+            const int free_threads = thread_budget - threads_in_use;
+            const int slots = std::min(jobs - static_cast<int>(running.size()), static_cast<int>(pending.size()));
+            int threads = c.threads > 0 ? c.threads : std::max(1, free_threads / slots);
+            if (!running.empty() && threads > free_threads) break;
+
+            std::error_code ec;
+            fs::create_directories(c.output_dir, ec);
+            if (ec) {
+                std::cerr << "[FAILED] " << c.name << ": could not create " << c.output_dir << "\n";
+                ++failed;
+                pending.pop_front();
+                continue;
+            }
+
+            std::cout.flush();
+            std::cerr.flush();
+            const auto start = std::chrono::steady_clock::now();
+            const pid_t pid = fork();
+            if (pid < 0) throw std::runtime_error("fork() failed");
+            if (pid == 0) run_case_process(c, threads);
+
+            std::cout << "[start]  " << c.name << " (" << threads << " threads) -> " << c.output_dir << "\n";
+            running[pid] = {pending.front(), threads, start};
+            threads_in_use += threads;
+            pending.pop_front();
+        }
+        if (running.empty()) continue;
+
+        int status = 0;
+        struct rusage usage;
+        const pid_t pid = wait4(-1, &status, 0, &usage);
+        if (pid < 0) throw std::runtime_error("wait4() failed");
+        auto it = running.find(pid);
+        if (it == running.end()) continue;
+
+        const CaseSettings& c = cases[it->second.index];
+        const double seconds = seconds_since(it->second.start);
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+            std::cout << "[done]   " << c.name << " in " << seconds << " s, peak "
+                      << usage.ru_maxrss / 1024 << " MB\n";   // kilobytes on Linux
+        } else {
+            std::cout << "[FAILED] " << c.name << " after " << seconds << " s, see "
+                      << c.output_dir << "/REEF2FAST.log\n";
+            ++failed;
+        }
+        threads_in_use -= it->second.threads;
+        running.erase(it);
+    }
+
+    std::cout << "\nBatch finished: " << cases.size() - static_cast<size_t>(failed) << " of " << cases.size()
+              << " cases succeeded in " << seconds_since(batch_start) << " s\n";
+    return failed;
+}
\ No newline at end of file
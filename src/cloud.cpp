@@ -3,34 +3,15 @@
 #include "common.hpp"
 #include "structs.hpp"
 #include "report_diagnostics.hpp"
+#include "spatial_index.hpp"
+#include "idw_kernel.hpp"
 
 #include <iostream>
 #include <cmath>
 #include <algorithm>
+#include <stdexcept>
 #include <omp.h>
 
-#include "../external/nanoflann.hpp"
-
-// Internal struct for KDTree
-struct PointCloud {
-    struct Point { double x, y, z; };
-    std::vector<Point> pts;
-
-    inline size_t kdtree_get_point_count() const { return pts.size(); }
-    inline double kdtree_get_pt(const size_t idx, const size_t dim) const {
-        if (dim == 0) return pts[idx].x;
-        if (dim == 1) return pts[idx].y;
-        return pts[idx].z;
-    }
-    template <class BBOX> bool kdtree_get_bbox(BBOX&) const { return false; }
-};
-
-// Alias for nanoflann KDTree
-using KDTree = nanoflann::KDTreeSingleIndexAdaptor<
-    nanoflann::L2_Simple_Adaptor<double, PointCloud>,
-    PointCloud,
-    3
->;
 
 // Generates OpenFAST SeaState target grid based on control.txt
 void generate_seastate_grid_targets(const std::string& control_file,
@@ -68,46 +49,75 @@ void generate_seastate_grid_targets(const std::string& control_file,
 }
 
 // Interpolates a scalar field to the given grid using inverse-distance weighting
-std::vector<double> interpolate_to_grid(const Wavefield& wf,
-                                        const std::vector<std::array<double, 3>>& target_pts,
-                                        const std::string& field,
-                                        int k) {
-    PointCloud cloud;
-    std::vector<double> values;
-
-    for (const auto& e : wf) {
-        cloud.pts.push_back({e.x, e.y, e.z});
-        if (field == "vx") values.push_back(e.vx);
-        else if (field == "vy") values.push_back(e.vy);
-        else if (field == "vz") values.push_back(e.vz);
-        else if (field == "pressure") values.push_back(e.pressure);
-    }
-
-    KDTree tree(3, cloud, nanoflann::KDTreeSingleIndexAdaptorParams(10));
-    tree.buildIndex();
-
-    std::vector<double> result(target_pts.size());
-
-    #pragma omp parallel for schedule(static)
-    for (int i = 0; i < static_cast<int>(target_pts.size()); ++i) {
-        const auto& pt = target_pts[i];
+std::vector<Value> interpolate_to_grid(const Wavefield& wf,
+                                       const std::vector<std::array<double, 3>>& target_pts,
+                                       const std::string& field,
+                                       int k) {
+    SpatialIndex index(3, k);
+    return interpolate_to_grid(wf, index.query(wf, target_pts), field);
+}
 
-        std::vector<size_t> indices(k);
-        std::vector<double> dists(k);
-        nanoflann::KNNResultSet<double> resultSet(k);
-        resultSet.init(indices.data(), dists.data());
-        tree.findNeighbors(resultSet, pt.data(), nanoflann::SearchParameters(10));
+// Maps a field name ("vx", "vy", "vz", "pressure") to its InterpField bit
+static unsigned field_mask(const std::string& field) {
+    if (field == "vx") return FIELD_VX;
+    if (field == "vy") return FIELD_VY;
+    if (field == "vz") return FIELD_VZ;
+    if (field == "pressure") return FIELD_PRESSURE;
+    throw std::invalid_argument("Unknown interpolation field: " + field);
+}
 
-        double sum_weights = 0.0, weighted_val = 0.0;
-        for (size_t j = 0; j < resultSet.size(); ++j) {
-            double dist = std::sqrt(dists[j]) + 1e-6;
-            double w = 1.0 / dist;
-            sum_weights += w;
-            weighted_val += w * values[indices[j]];
-        }
+// Inverse-distance weighting over precomputed neighbours (2D or 3D)
+std::vector<Value> interpolate_to_grid(const Wavefield& wf,
+                                       const NeighbourList& neighbours,
+                                       const std::string& field) {
+    unsigned mask = field_mask(field);
+    GridFrame out;
+    interpolate_fields(wf, neighbours, mask, out);
+
+    if (mask == FIELD_VX) return std::move(out.vx);
+    if (mask == FIELD_VY) return std::move(out.vy);
+    if (mask == FIELD_VZ) return std::move(out.vz);
+    return std::move(out.pressure);
+}
 
-        result[i] = weighted_val / sum_weights;
-    }
+void interpolate_fields(const Wavefield& wf,
+                        const NeighbourList& neighbours,
+                        unsigned fields,
+                        GridFrame& out) {
+    const size_t n = neighbours.num_targets();
+
+    std::vector<Value> columns[4];
+    const Value* column_ptrs[4];
+    Value* out_ptrs[4];
+    int num_fields = 0;
+
+    // Raw values of each requested field as a contiguous column (SoA)
+    auto add_field = [&](unsigned bit, Value WavefieldEntry::*member, std::vector<Value>& result) {
+        if (!(fields & bit)) return;
+        auto& column = columns[num_fields];
+        column.resize(wf.size());
+        for (size_t s = 0; s < wf.size(); ++s) column[s] = wf[s].*member;
+        result.resize(n);
+        column_ptrs[num_fields] = column.data();
+        out_ptrs[num_fields] = result.data();
+        ++num_fields;
+    };
+
+    add_field(FIELD_VX, &WavefieldEntry::vx, out.vx);
+    add_field(FIELD_VY, &WavefieldEntry::vy, out.vy);
+    add_field(FIELD_VZ, &WavefieldEntry::vz, out.vz);
+    add_field(FIELD_PRESSURE, &WavefieldEntry::pressure, out.pressure);
+
+    // Weights are computed once per target and shared by all fields
+    if (num_fields > 0) idw::interpolate(neighbours, column_ptrs, num_fields, out_ptrs);
+}
 
-    return result;
+GridFrame interpolate_fields_to_grid(const Wavefield& wf,
+                                     const std::vector<std::array<double, 3>>& target_pts,
+                                     unsigned fields,
+                                     int k) {
+    SpatialIndex index(3, k);
+    GridFrame out;
+    interpolate_fields(wf, index.query(wf, target_pts), fields, out);
+    return out;
 }
@@ -1,8 +1,8 @@
 #include "common.hpp"
+#include "scientific_format.hpp"
 #include <iostream>
 #include <fstream>
 #include <sstream>
-#include <iomanip>
 #include <vector>
 #include <string>
 #include <filesystem>
@@ -67,9 +67,8 @@ double read_z_max(const std::string& filename) {
 
 // --- Format value as scientific string ---
 std::string format_scientific(double value) {
-    std::ostringstream stream;
-    stream << std::scientific << std::setprecision(4) << value;
-    return stream.str();
+    char buf[MAX_SCIENTIFIC_CHARS];
+    return std::string(buf, write_scientific(buf, value));
 }
 
 // --- Read timestep and sim time from ctrl.txt ---
@@ -1,102 +1,181 @@
 #include "export.hpp"
-#include "common.hpp"
-#include <iostream>
-#include <fstream>
-#include <set>
-#include <map>
-#include <vector>
-#include <cmath>
+#include "scientific_format.hpp"
 #include <algorithm>
+#include <cstring>
+#include <iostream>
+
+const WaveComponent WAVE_COMPONENTS[NUM_WAVE_COMPONENTS] = {
+    {"REEF2FAST.Vxi",  "Fluid Velocity along X-direction (m/s)",      &GridFrame::vx,       false},
+    {"REEF2FAST.Vyi",  "Fluid Velocity along Y-direction (m/s)",      &GridFrame::vy,       true},
+    {"REEF2FAST.Vzi",  "Fluid Velocity along Z-direction (m/s)",      &GridFrame::vz,       false},
+    {"REEF2FAST.Axi",  "Fluid Acceleration along X-direction (m/s²)", &GridFrame::ax,       false},
+    {"REEF2FAST.Ayi",  "Fluid Acceleration along Y-direction (m/s²)", &GridFrame::ay,       true},
+    {"REEF2FAST.Azi",  "Fluid Acceleration along Z-direction (m/s²)", &GridFrame::az,       false},
+    {"REEF2FAST.DynP", "Dynamic Pressure (Pa)",                       &GridFrame::pressure, false},
+};
 
-void write_wave_component(const Wavefield& wf,
-                          const std::string& filename,
-                          const std::string& component_name,
-                          const std::string& description,
-                          std::function<double(const WavefieldEntry&)> accessor,
-                          double wave_dt,
-                          int timestep,
-                          bool append)
+namespace {
+
+// Formats all rows of one timestep into n files at once, one pass over the
+// points in row order. cursor[f] must have room for wavefile_block_bytes()
+// and is advanced past the text. Fixed pads every value and the time to
+// MAX_SCIENTIFIC_CHARS characters. A value row printed again (2D broadcast)
+// repeats the text of the previous row; zero vy / ay rows are copied from
+// the layout's constant line.
+template <bool Fixed>
+void format_rows(const SeaStateLayout& layout,
+                 const WaveComponent* const* components,
+                 const Value* const* values,
+                 size_t n,
+                 int timestep,
+                 char** cursor)
 {
-    std::ofstream file;
-    if (append) {
-        file.open("../output/" + filename, std::ios::app);
-    } else {
-        file.open("../output/" + filename);
-    }
+    char time[MAX_SCIENTIFIC_CHARS];
+    const double t = timestep * layout.wave_dt;
+    const size_t time_len = static_cast<size_t>(
+        (Fixed ? write_scientific_padded(time, t) : write_scientific(time, t)) - time);
 
-    if (!file) {
-        std::cerr << "Error: Could not open " << filename << " for writing.\n";
-        return;
+    char zero[MAX_SCIENTIFIC_CHARS];
+    const size_t zero_width = static_cast<size_t>(
+        (Fixed ? write_scientific_padded(zero, 0.0) : write_scientific(zero, 0.0)) - zero) + 1;
+    const std::string& zero_row = Fixed ? layout.zero_row_padded : layout.zero_row;
+
+    // Files formatted from their values and files printing the zero line
+    size_t computed[NUM_WAVE_COMPONENTS], constant[NUM_WAVE_COMPONENTS];
+    size_t num_computed = 0, num_constant = 0;
+    for (size_t f = 0; f < n; ++f) {
+        if (layout.transverse_zero && components[f]->transverse) constant[num_constant++] = f;
+        else computed[num_computed++] = f;
     }
 
-    // Write header only if file is new
-    if (!append) {
-        std::set<double> x_coords, y_coords, z_coords;
+    // Value text of the previous row, per file
+    const char* row_text[NUM_WAVE_COMPONENTS];
+    size_t row_bytes[NUM_WAVE_COMPONENTS];
 
-        for (const auto& e : wf) {
-            x_coords.insert(e.x);
-            y_coords.insert(e.y);
-            z_coords.insert(e.z);
-        }
+    for (size_t r = 0; r < layout.rows(); ++r) {
+        const size_t v = layout.row_source[r];
+        if (r > 0 && layout.row_source[r - 1] == v) {
+            for (size_t f = 0; f < n; ++f) {
+                std::memcpy(cursor[f], row_text[f], row_bytes[f]);
+                row_text[f] = cursor[f];
+                cursor[f] += row_bytes[f];
+            }
+        } else {
+            const size_t* first = layout.order.data() + layout.row_begin[v];
+            const size_t* last = layout.order.data() + layout.row_begin[v + 1];
 
-        if (x_coords.size() < 2 || y_coords.size() < 2 || z_coords.size() < 2) {
-            std::cerr << "Insufficient spatial resolution in grid.\n";
-            return;
+            for (size_t f = 0; f < n; ++f) row_text[f] = cursor[f];
+            for (const size_t* i = first; i != last; ++i) {
+                for (size_t c = 0; c < num_computed; ++c) {
+                    const size_t f = computed[c];
+                    const double val = static_cast<double>(values[f][*i]);
+                    char* p = Fixed ? write_scientific_padded(cursor[f], val) : write_scientific(cursor[f], val);
+                    *p++ = ' ';
+                    cursor[f] = p;
+                }
+            }
+            const size_t zero_bytes = static_cast<size_t>(last - first) * zero_width;
+            for (size_t c = 0; c < num_constant; ++c) {
+                const size_t f = constant[c];
+                std::memcpy(cursor[f], zero_row.data(), zero_bytes);
+                cursor[f] += zero_bytes;
+            }
+            for (size_t f = 0; f < n; ++f) row_bytes[f] = static_cast<size_t>(cursor[f] - row_text[f]);
         }
 
-        double dx = *std::next(x_coords.begin()) - *x_coords.begin();
-        double dy = *std::next(y_coords.begin()) - *y_coords.begin();
-        double z_max = *z_coords.rbegin();
-        double dthetaZ = M_PI / (2.0 * (z_coords.size() - 1));
-
-        file << "This wave kinematics file was generated by REEF2FAST\n";
-        file << description << "\n";
-        file << "! " << format_scientific(wave_dt) << "  - WaveDT (s)\n";
-        file << "! " << x_coords.size() << "  - NX*2 - 1\n";
-        file << "! " << y_coords.size() << "  - NY*2 - 1\n";
-        file << "! " << z_coords.size() << "  - NZ\n";
-        file << "! " << format_scientific(dx) << "  - dX (m)\n";
-        file << "! " << format_scientific(dy) << "  - dY (m)\n";
-        file << "! " << format_scientific(z_max) << "  - Z_Depth (m)\n";
-        file << "! " << format_scientific(dthetaZ) << "  - dthetaZ (rad)\n";
-
-        file << "! "; for (const auto& x : x_coords) file << format_scientific(x) << " "; file << "- X-Locations (m)\n";
-        file << "! "; for (const auto& y : y_coords) file << format_scientific(y) << " "; file << "- Y-Locations (m)\n";
-        file << "! "; for (const auto& z : z_coords) file << format_scientific(z) << " "; file << "- Z-Locations (m)\n";
+        const std::string& label = layout.row_label[r];
+        for (size_t f = 0; f < n; ++f) {
+            char* p = cursor[f];
+            p = std::copy(label.begin(), label.end(), p);
+            p = std::copy(time, time + time_len, p);
+            *p++ = '\n';
+            cursor[f] = p;
+        }
     }
+}
 
-    // Group values by z → y → [vx1, vx2, ...] at each x
-    std::map<double, std::map<double, std::vector<double>>> grouped;
-    for (const auto& e : wf) {
-        double z = round_to(e.z);
-        double y = round_to(e.y);
-        grouped[z][y].push_back(accessor(e));
-    }
+} // namespace
 
-    for (const auto& [z, y_map] : grouped) {
-        for (const auto& [y, values] : y_map) {
-            for (const auto& v : values) {
-                file << format_scientific(v) << " ";
-            }
-            file << "! All X values at Y = " << format_scientific(y)
-                 << ", Z = " << format_scientific(z)
-                 << ", Time = " << format_scientific(timestep * wave_dt) << "\n";
-        }
+std::string wavefile_header(const SeaStateLayout& layout, const WaveComponent& component) {
+    std::string header = "This wave kinematics file was generated by REEF2FAST\n";
+    header += component.description;
+    header += '\n';
+    header += layout.kinematics_header;
+    return header;
+}
+
+size_t wavefile_block_bytes(const SeaStateLayout& layout) {
+    size_t bytes = 0;
+    for (size_t r = 0; r < layout.rows(); ++r) {
+        const size_t v = layout.row_source[r];
+        const size_t n = layout.row_begin[v + 1] - layout.row_begin[v];
+        bytes += n * (MAX_SCIENTIFIC_CHARS + 1) + layout.row_label[r].size() + MAX_SCIENTIFIC_CHARS + 1;
     }
+    return bytes;
+}
 
-    file.close();
+void format_wavefile_blocks(const SeaStateLayout& layout,
+                            const GridFrame& frame,
+                            int timestep,
+                            char* const* out)
+{
+    const WaveComponent* components[NUM_WAVE_COMPONENTS];
+    const Value* values[NUM_WAVE_COMPONENTS];
+    char* cursor[NUM_WAVE_COMPONENTS];
+    for (size_t c = 0; c < NUM_WAVE_COMPONENTS; ++c) {
+        components[c] = &WAVE_COMPONENTS[c];
+        values[c] = (frame.*WAVE_COMPONENTS[c].column).data();
+        cursor[c] = out[c];
+    }
+    format_rows<true>(layout, components, values, NUM_WAVE_COMPONENTS, timestep, cursor);
 }
 
-void generate_all_wavefiles(const Wavefield& wf,
-                            double wave_dt,
+void generate_all_wavefiles(OutputWriter& writer,
+                            const SeaStateLayout& layout,
+                            const GridFrame& frame,
+                            const std::string& output_dir,
                             int timestep,
                             bool append)
 {
-    write_wave_component(wf, "REEF2FAST.Vxi", "vx", "Fluid Velocity along X-direction (m/s)", [](const WavefieldEntry& e) { return e.vx; }, wave_dt, timestep, append);
-    write_wave_component(wf, "REEF2FAST.Vyi", "vy", "Fluid Velocity along Y-direction (m/s)", [](const WavefieldEntry& e) { return e.vy; }, wave_dt, timestep, append);
-    write_wave_component(wf, "REEF2FAST.Vzi", "vz", "Fluid Velocity along Z-direction (m/s)", [](const WavefieldEntry& e) { return e.vz; }, wave_dt, timestep, append);
-    write_wave_component(wf, "REEF2FAST.Axi", "ax", "Fluid Acceleration along X-direction (m/s²)", [](const WavefieldEntry& e) { return e.ax; }, wave_dt, timestep, append);
-    write_wave_component(wf, "REEF2FAST.Ayi", "ay", "Fluid Acceleration along Y-direction (m/s²)", [](const WavefieldEntry& e) { return e.ay; }, wave_dt, timestep, append);
-    write_wave_component(wf, "REEF2FAST.Azi", "az", "Fluid Acceleration along Z-direction (m/s²)", [](const WavefieldEntry& e) { return e.az; }, wave_dt, timestep, append);
-    write_wave_component(wf, "REEF2FAST.DynP", "pressure", "Dynamic Pressure (Pa)", [](const WavefieldEntry& e) { return e.pressure; }, wave_dt, timestep, append);
+    // Files that could be opened, with their component and values
+    const WaveComponent* components[NUM_WAVE_COMPONENTS];
+    std::string* files[NUM_WAVE_COMPONENTS];
+    const Value* values[NUM_WAVE_COMPONENTS];
+    size_t open = 0;
+    for (const WaveComponent& c : WAVE_COMPONENTS) {
+        std::string* out = writer.buffer(output_dir + "/" + c.filename, append);
+        if (!out) {
+            std::cerr << "Error: Could not open " << c.filename << " for writing.\n";
+            continue;
+        }
+        components[open] = &c;
+        files[open] = out;
+        values[open] = (frame.*c.column).data();
+        ++open;
+    }
+
+    // Write header only if files are new
+    if (!append) {
+        if (!layout.kinematics_valid) {
+            std::cerr << "Insufficient spatial resolution in grid.\n";
+            return;
+        }
+        for (size_t f = 0; f < open; ++f) *files[f] += wavefile_header(layout, *components[f]);
+    }
+
+    // The fixed-width size bounds the text of every file
+    const size_t max_bytes = wavefile_block_bytes(layout);
+    char* cursor[NUM_WAVE_COMPONENTS];
+    for (size_t f = 0; f < open; ++f) {
+        std::string& file = *files[f];
+        const size_t begin = file.size();
+        file.resize(begin + max_bytes);
+        cursor[f] = &file[begin];
+    }
+
+    format_rows<false>(layout, components, values, open, timestep, cursor);
+
+    for (size_t f = 0; f < open; ++f) {
+        files[f]->resize(static_cast<size_t>(cursor[f] - files[f]->data()));
+    }
 }
\ No newline at end of file
@@ -1,80 +1,99 @@
 #include "export_elevation.hpp"
-#include "common.hpp"
-#include <fstream>
-#include <iostream>
-#include <set>
-#include <map>
-#include <vector>
-#include <cmath>
+#include "scientific_format.hpp"
 #include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
 
-void write_surface_elevation(const Wavefield& wf,
-                             const std::string& filename,
-                             double wave_dt,
+// Formats all rows of one timestep at out (room for elevation_block_bytes())
+// and returns the end of the text. Fixed pads every value and the time to
+// MAX_SCIENTIFIC_CHARS characters. A value row printed again (2D broadcast)
+// repeats the text of the previous row.
+template <bool Fixed>
+char* format_rows(const SeaStateLayout& layout, const GridFrame& frame, int timestep, char* p) {
+    char time[MAX_SCIENTIFIC_CHARS];
+    const double t = timestep * layout.wave_dt;
+    const size_t time_len = static_cast<size_t>(
+        (Fixed ? write_scientific_padded(time, t) : write_scientific(time, t)) - time);
+
+    const char* row_text = p;
+    size_t row_bytes = 0;
+    for (size_t r = 0; r < layout.surface_rows(); ++r) {
+        const size_t v = layout.surface_row_source[r];
+        if (r > 0 && layout.surface_row_source[r - 1] == v) {
+            std::memcpy(p, row_text, row_bytes);
+            row_text = p;
+            p += row_bytes;
+        } else {
+            row_text = p;
+            for (size_t k = layout.surface_row_begin[v]; k < layout.surface_row_begin[v + 1]; ++k) {
+                const double eta = static_cast<double>(frame.elevation[layout.surface_order[k]]);
+                p = Fixed ? write_scientific_padded(p, eta) : write_scientific(p, eta);
+                *p++ = ' ';
+            }
+            row_bytes = static_cast<size_t>(p - row_text);
+        }
+        const std::string& label = layout.surface_row_label[r];
+        p = std::copy(label.begin(), label.end(), p);
+        p = std::copy(time, time + time_len, p);
+        *p++ = '\n';
+    }
+    return p;
+}
+
+} // namespace
+
+size_t elevation_block_bytes(const SeaStateLayout& layout) {
+    size_t bytes = 0;
+    for (size_t r = 0; r < layout.surface_rows(); ++r) {
+        const size_t v = layout.surface_row_source[r];
+        const size_t n = layout.surface_row_begin[v + 1] - layout.surface_row_begin[v];
+        bytes += n * (MAX_SCIENTIFIC_CHARS + 1) + layout.surface_row_label[r].size() + MAX_SCIENTIFIC_CHARS + 1;
+    }
+    return bytes;
+}
+
+void format_elevation_block(const SeaStateLayout& layout,
+                            const GridFrame& frame,
+                            int timestep,
+                            char* out)
+{
+    format_rows<true>(layout, frame, timestep, out);
+}
+
+void write_surface_elevation(OutputWriter& writer,
+                             const SeaStateLayout& layout,
+                             const GridFrame& frame,
+                             const std::string& path,
                              int timestep,
                              bool append)
 {
-    const std::string fullpath = "../output/" + filename;
-    std::ofstream file(fullpath, append ? std::ios::app : std::ios::out);
+    std::string* out = writer.buffer(path, append);
 
-    if (!file.is_open()) {
-        std::cerr << "[Error] Could not open " << fullpath << " for writing.\n";
+    if (!out) {
+        std::cerr << "[Error] Could not open " << path << " for writing.\n";
         return;
     }
+    std::string& file = *out;
 
-    // Collect surface points
-    std::set<double> x_coords, y_coords;
-    std::map<double, std::vector<std::pair<double, double>>> y_to_xelev;
-
-    for (const auto& e : wf) {
-        if (round_to(e.z) == 0.0) {
-            double x = round_to(e.x);
-            double y = round_to(e.y);
-            x_coords.insert(x);
-            y_coords.insert(y);
-            y_to_xelev[y].emplace_back(x, e.elevation);
-        }
-    }
-
-    if (y_to_xelev.empty()) {
+    if (layout.surface_order.empty()) {
         std::cerr << "[Warning] No surface points (z ≈ 0.0) found at timestep " << timestep << "\n";
-        file.close();
         return;
     }
 
     // Write header only for first timestep
     if (!append) {
-        if (x_coords.size() < 2 || y_coords.size() < 2) {
+        if (!layout.elevation_valid) {
             std::cerr << "[Error] Not enough surface points for grid metadata.\n";
-            file.close();
             return;
         }
-
-        double dx = *std::next(x_coords.begin()) - *x_coords.begin();
-        double dy = *std::next(y_coords.begin()) - *y_coords.begin();
-
-        file << "This surface elevation file was generated by REEF2FAST\n";
-        file << "Surface elevation relative to still water level (m)\n";
-        file << "! " << format_scientific(wave_dt) << "  - WaveDT (s)\n";
-        file << "! " << x_coords.size() << "  - NX*2 - 1\n";
-        file << "! " << y_coords.size() << "  - NY*2 - 1\n";
-        file << "! " << format_scientific(dx) << "  - dX (m)\n";
-        file << "! " << format_scientific(dy) << "  - dY (m)\n";
-        file << "!\n!\n!\n!\n";
-        file << "! "; for (const auto& x : x_coords) file << format_scientific(x) << " "; file << "- X positions\n";
-        file << "! "; for (const auto& y : y_coords) file << format_scientific(y) << " "; file << "- Y positions\n";
-    }
-
-    // Write elevation data grouped by Y
-    for (auto& [y, vec] : y_to_xelev) {
-        std::sort(vec.begin(), vec.end()); // sort by x
-        for (const auto& [x, eta] : vec) {
-            file << format_scientific(eta) << " ";
-        }
-        file << "! Y = " << format_scientific(y)
-             << ", Time = " << format_scientific(timestep * wave_dt) << "\n";
+        file += layout.elevation_header;
     }
 
-    file << std::flush;
-    file.close();
+    // Write elevation data grouped by Y; the fixed-width size bounds the text
+    const size_t begin = file.size();
+    file.resize(begin + elevation_block_bytes(layout));
+    char* end = format_rows<false>(layout, frame, timestep, &file[begin]);
+    file.resize(static_cast<size_t>(end - file.data()));
 }
\ No newline at end of file
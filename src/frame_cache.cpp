@@ -0,0 +1,198 @@
+#include "frame_cache.hpp"
+#include "mapped_file.hpp"
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char CACHE_MAGIC[8] = {'R', '2', 'F', 'C', 'A', 'C', 'H', 'E'};
+constexpr uint32_t CACHE_VERSION = 1;
+
+// 64 bytes, so the row block after it stays 8-byte aligned inside the mapping
+struct FrameCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t row_size;
+    uint64_t source_size;
+    int64_t source_mtime;
+    uint64_t num_frames;
+    uint64_t num_rows;
+    uint64_t index_offset;
+    uint64_t reserved;
+};
+
+struct FrameIndexRecord {
+    int64_t timestep;
+    uint64_t first_row;
+    uint64_t num_rows;
+};
+
+static_assert(sizeof(FrameCacheHeader) == 64, "FrameCacheHeader must stay 64 bytes");
+static_assert(sizeof(CachedRow) == 8 * sizeof(double), "CachedRow must be tightly packed");
+
+// Size and mtime of the source CSV, used to detect stale caches
+bool source_stamp(const std::string& csv_file, uint64_t& size, int64_t& mtime) {
+    std::error_code ec;
+    size = fs::file_size(csv_file, ec);
+    if (ec) return false;
+    auto t = fs::last_write_time(csv_file, ec);
+    if (ec) return false;
+    mtime = static_cast<int64_t>(t.time_since_epoch().count());
+    return true;
+}
+
+} // namespace
+
+std::string frame_cache_path(const std::string& csv_file) {
+    return csv_file + ".r2fc";
+}
+
+// --- Writer ---
+
+FrameCacheWriter::FrameCacheWriter(const std::string& csv_file)
+    : csv_file(csv_file),
+      final_path(frame_cache_path(csv_file)),
+      tmp_path(frame_cache_path(csv_file) + ".tmp"),
+      write_buffer(1 << 20),
+      rows_written(0),
+      current_timestep(0),
+      current_first_row(0),
+      frame_open(false)
+{
+    file.rdbuf()->pubsetbuf(write_buffer.data(), write_buffer.size());
+    file.open(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "[FrameCache] Could not create " << tmp_path << ", continuing without cache.\n";
+        return;
+    }
+
+    // Placeholder header, rewritten by finalize()
+    FrameCacheHeader header{};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+FrameCacheWriter::~FrameCacheWriter() {
+    // Not finalized: drop the partial file
+    if (file.is_open()) {
+        file.close();
+        std::error_code ec;
+        fs::remove(tmp_path, ec);
+    }
+}
+
+void FrameCacheWriter::close_frame() {
+    if (!frame_open) return;
+    frames.push_back({current_timestep, current_first_row, rows_written - current_first_row});
+    frame_open = false;
+}
+
+void FrameCacheWriter::append(int timestep, const CachedRow& row) {
+    if (!file.is_open()) return;
+
+    if (!frame_open || timestep != current_timestep) {
+        close_frame();
+        current_timestep = timestep;
+        current_first_row = rows_written;
+        frame_open = true;
+    }
+
+    file.write(reinterpret_cast<const char*>(&row), sizeof(CachedRow));
+    ++rows_written;
+}
+
+bool FrameCacheWriter::finalize() {
+    if (!file.is_open()) return false;
+    close_frame();
+
+    FrameCacheHeader header{};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.row_size = sizeof(CachedRow);
+    header.num_frames = frames.size();
+    header.num_rows = rows_written;
+    header.index_offset = sizeof(FrameCacheHeader) + rows_written * sizeof(CachedRow);
+
+    if (!source_stamp(csv_file, header.source_size, header.source_mtime)) {
+        file.close();
+        std::error_code ec;
+        fs::remove(tmp_path, ec);
+        return false;
+    }
+
+    for (const auto& f : frames) {
+        FrameIndexRecord rec{f.timestep, f.first_row, f.num_rows};
+        file.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+    }
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+
+    if (!file) {
+        std::cerr << "[FrameCache] Failed to write " << tmp_path << "\n";
+        std::error_code ec;
+        fs::remove(tmp_path, ec);
+        return false;
+    }
+
+    std::error_code ec;
+    fs::rename(tmp_path, final_path, ec);
+    if (ec) {
+        std::cerr << "[FrameCache] Could not move cache into place: " << ec.message() << "\n";
+        fs::remove(tmp_path, ec);
+        return false;
+    }
+
+    std::cout << "Frame cache written: " << final_path
+              << " (" << frames.size() << " timesteps, " << rows_written << " rows)\n";
+    return true;
+}
+
+// --- Reader ---
+
+bool read_frame_cache(const std::string& csv_file,
+                      const std::function<void(int, const CachedRow*, size_t)>& frame_fn) {
+    const std::string path = frame_cache_path(csv_file);
+
+    uint64_t src_size = 0;
+    int64_t src_mtime = 0;
+    if (!source_stamp(csv_file, src_size, src_mtime)) return false;
+
+    MappedFile map;
+    if (!map.open(path) || map.size() < sizeof(FrameCacheHeader)) return false;
+
+    FrameCacheHeader header;
+    std::memcpy(&header, map.data(), sizeof(header));
+
+    bool valid = std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0
+              && header.version == CACHE_VERSION
+              && header.row_size == sizeof(CachedRow)
+              && header.source_size == src_size
+              && header.source_mtime == src_mtime
+              && header.index_offset == sizeof(FrameCacheHeader) + header.num_rows * sizeof(CachedRow)
+              && header.index_offset + header.num_frames * sizeof(FrameIndexRecord) == map.size();
+
+    const CachedRow* rows = reinterpret_cast<const CachedRow*>(map.data() + sizeof(FrameCacheHeader));
+    const FrameIndexRecord* index = reinterpret_cast<const FrameIndexRecord*>(map.data() + header.index_offset);
+
+    for (uint64_t f = 0; valid && f < header.num_frames; ++f) {
+        valid = index[f].first_row + index[f].num_rows <= header.num_rows;
+    }
+
+    if (!valid) {
+        std::cout << "Frame cache " << path << " is stale or invalid, re-parsing CSV.\n";
+        return false;
+    }
+
+    map.advise_sequential();
+    std::cout << "Reading wavefield from frame cache: " << path << "\n";
+
+    for (uint64_t f = 0; f < header.num_frames; ++f) {
+        frame_fn(static_cast<int>(index[f].timestep), rows + index[f].first_row, index[f].num_rows);
+    }
+
+    return true;
+}
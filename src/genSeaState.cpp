@@ -46,8 +46,9 @@ bool read_wave_parameters(const string& filename, double& sim_time, double& wave
 
 // This function generates the main input file for OpenFAST simulation with a flag on SeaState.
 void generate_seastate(double X_MIN, double X_MAX, double Y_MIN, double Y_MAX, double Z_MIN, double Z_MAX, 
-                       int NX, int NY, int NZ, double sim_time, double wave_dt, double wave_hs, double wave_tp) {
-    string output_filename = "../output/REEF2FAST.dat";
+                       int NX, int NY, int NZ, double sim_time, double wave_dt, double wave_hs, double wave_tp,
+                       const string& output_dir) {
+    string output_filename = output_dir + "/REEF2FAST.dat";
     ofstream outfile(output_filename);
     if (!outfile) {
         cerr << "Error: Could not create " << output_filename << endl;
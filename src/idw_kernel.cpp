@@ -0,0 +1,199 @@
+#include "idw_kernel.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include <omp.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define IDW_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Scalar reference, also used for the tail of the SIMD loops
+void kernel_scalar(size_t begin, size_t n, int k,
+                   const double* dists, const double* const* values,
+                   int num_fields, double* const* out) {
+    for (size_t i = begin; i < n; ++i) {
+        double sum_weights = 0.0;
+        double acc[idw::MAX_FIELDS] = {};
+        for (int j = 0; j < k; ++j) {
+            double dist = std::sqrt(dists[j * n + i]) + 1e-6;
+            double w = 1.0 / dist;
+            sum_weights += w;
+            for (int f = 0; f < num_fields; ++f) acc[f] += w * values[f][j * n + i];
+        }
+        for (int f = 0; f < num_fields; ++f) out[f][i] = acc[f] / sum_weights;
+    }
+}
+
+#ifdef IDW_X86
+
+__attribute__((target("sse2")))
+void kernel_sse2(size_t begin, size_t n, int k,
+                 const double* dists, const double* const* values,
+                 int num_fields, double* const* out) {
+    const __m128d eps = _mm_set1_pd(1e-6);
+    const __m128d one = _mm_set1_pd(1.0);
+
+    size_t i = begin;
+    for (; i + 2 <= n; i += 2) {
+        __m128d sum_weights = _mm_setzero_pd();
+        __m128d acc[idw::MAX_FIELDS];
+        for (int f = 0; f < num_fields; ++f) acc[f] = _mm_setzero_pd();
+
+        for (int j = 0; j < k; ++j) {
+            __m128d dist = _mm_add_pd(_mm_sqrt_pd(_mm_loadu_pd(dists + j * n + i)), eps);
+            __m128d w = _mm_div_pd(one, dist);
+            sum_weights = _mm_add_pd(sum_weights, w);
+            for (int f = 0; f < num_fields; ++f) {
+                acc[f] = _mm_add_pd(acc[f], _mm_mul_pd(w, _mm_loadu_pd(values[f] + j * n + i)));
+            }
+        }
+        for (int f = 0; f < num_fields; ++f) _mm_storeu_pd(out[f] + i, _mm_div_pd(acc[f], sum_weights));
+    }
+
+    kernel_scalar(i, n, k, dists, values, num_fields, out);
+}
+
+__attribute__((target("avx2")))
+void kernel_avx2(size_t begin, size_t n, int k,
+                 const double* dists, const double* const* values,
+                 int num_fields, double* const* out) {
+    const __m256d eps = _mm256_set1_pd(1e-6);
+    const __m256d one = _mm256_set1_pd(1.0);
+
+    size_t i = begin;
+    for (; i + 4 <= n; i += 4) {
+        __m256d sum_weights = _mm256_setzero_pd();
+        __m256d acc[idw::MAX_FIELDS];
+        for (int f = 0; f < num_fields; ++f) acc[f] = _mm256_setzero_pd();
+
+        for (int j = 0; j < k; ++j) {
+            __m256d dist = _mm256_add_pd(_mm256_sqrt_pd(_mm256_loadu_pd(dists + j * n + i)), eps);
+            __m256d w = _mm256_div_pd(one, dist);
+            sum_weights = _mm256_add_pd(sum_weights, w);
+            for (int f = 0; f < num_fields; ++f) {
+                acc[f] = _mm256_add_pd(acc[f], _mm256_mul_pd(w, _mm256_loadu_pd(values[f] + j * n + i)));
+            }
+        }
+        for (int f = 0; f < num_fields; ++f) _mm256_storeu_pd(out[f] + i, _mm256_div_pd(acc[f], sum_weights));
+    }
+
+    kernel_sse2(i, n, k, dists, values, num_fields, out);
+}
+
+#endif
+
+// Processes targets [begin, n) of a block with n targets
+using KernelFn = void (*)(size_t, size_t, int, const double*, const double* const*, int, double* const*);
+
+struct Dispatch {
+    KernelFn fn;
+    const char* isa;
+};
+
+Dispatch select_kernel() {
+#ifdef IDW_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return {kernel_avx2, "avx2"};
+    return {kernel_sse2, "sse2"};
+#else
+    return {kernel_scalar, "scalar"};
+#endif
+}
+
+const Dispatch& dispatch() {
+    static const Dispatch d = select_kernel();
+    return d;
+}
+
+// The kernel writes double results straight into double columns; float
+// columns get them through a per-block scratch buffer
+inline double* direct_output(double* out) { return out; }
+inline double* direct_output(float*) { return nullptr; }
+
+// Targets gathered per kernel call: k * BLOCK doubles per field stay in L1/L2
+constexpr size_t BLOCK = 256;
+
+} // namespace
+
+namespace idw {
+
+void kernel(size_t n, int k,
+            const double* dists,
+            const double* const* values,
+            int num_fields,
+            double* const* out) {
+    dispatch().fn(0, n, k, dists, values, num_fields, out);
+}
+
+const char* kernel_isa() {
+    return dispatch().isa;
+}
+
+void interpolate(const NeighbourList& neighbours,
+                 const Value* const* columns,
+                 int num_fields,
+                 Value* const* out) {
+    const size_t n = neighbours.num_targets();
+    const int k = neighbours.k;
+    const int num_blocks = static_cast<int>((n + BLOCK - 1) / BLOCK);
+
+    #pragma omp parallel
+    {
+        TRACE_SPAN("IDW");   // per thread
+
+        // Per-thread SoA gather buffers
+        std::vector<double> dists(k * BLOCK);
+        std::vector<double> values(num_fields * k * BLOCK);
+        std::vector<double> results(std::is_same<Value, double>::value ? 0 : num_fields * BLOCK);
+        const double* value_ptrs[MAX_FIELDS];
+        double* out_ptrs[MAX_FIELDS];
+
+        #pragma omp for schedule(static) nowait
+        for (int b = 0; b < num_blocks; ++b) {
+            const size_t first = static_cast<size_t>(b) * BLOCK;
+            const size_t m = std::min(BLOCK, n - first);
+
+            // Slot-major gather, so every SoA row is written contiguously
+            for (int j = 0; j < k; ++j) {
+                double* d = &dists[j * m];
+                for (size_t i = 0; i < m; ++i) {
+                    const size_t t = first + i;
+                    d[i] = (j < neighbours.count[t]) ? neighbours.dists[t * k + j]
+                                                     : std::numeric_limits<double>::infinity();
+                }
+                for (int f = 0; f < num_fields; ++f) {
+                    double* v = &values[(f * k + j) * m];
+                    const Value* column = columns[f];
+                    for (size_t i = 0; i < m; ++i) {
+                        const size_t t = first + i;
+                        v[i] = (j < neighbours.count[t]) ? column[neighbours.indices[t * k + j]] : 0.0;
+                    }
+                }
+            }
+
+            for (int f = 0; f < num_fields; ++f) {
+                value_ptrs[f] = &values[f * k * m];
+                double* direct = direct_output(out[f] + first);
+                out_ptrs[f] = direct ? direct : &results[f * m];
+            }
+            kernel(m, k, dists.data(), value_ptrs, num_fields, out_ptrs);
+
+            // Single-precision storage: narrow the block results once
+            if (!std::is_same<Value, double>::value) {
+                for (int f = 0; f < num_fields; ++f) {
+                    std::copy(out_ptrs[f], out_ptrs[f] + m, out[f] + first);
+                }
+            }
+        }
+    }
+}
+
+} // namespace idw
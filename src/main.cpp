@@ -1,11 +1,64 @@
 #include "streamingpipeline.hpp"
+#include "batch_runner.hpp"
 #include "common.hpp"
+#include <cstdlib>
 #include <iostream>
 #include <filesystem>
 
 namespace fs = std::filesystem;
 
-int main() {
+static void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [--order 2|4] [--cache] [--workers N] [--export-threads N]\n"
+              << "       " << program << " --batch <cases.txt> [--jobs N] [--threads N]\n";
+}
+
+// Non-interactive run of the cases of a manifest:
+// REEF2FAST --batch <cases.txt> [--jobs N] [--threads N]
+static int batch_main(int argc, char** argv) {
+    std::string manifest;
+    int jobs = 0, threads = 0;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = (i + 1 < argc);
+        if (arg == "--batch" && has_value) manifest = argv[++i];
+        else if (arg == "--jobs" && has_value) jobs = std::atoi(argv[++i]);
+        else if (arg == "--threads" && has_value) threads = std::atoi(argv[++i]);
+        else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (manifest.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    try {
+        const std::vector<CaseSettings> cases = read_case_manifest(manifest);
+        return run_batch(cases, jobs, threads) == 0 ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "\nBatch failed: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+// Settings of an interactive run that are not asked for (defaults as in a manifest):
+// --order 2|4, --cache, --workers N, --export-threads N
+static bool parse_run_options(int argc, char** argv, CaseSettings& settings) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = (i + 1 < argc);
+        if (arg == "--cache") settings.use_frame_cache = true;
+        else if (arg == "--order" && has_value) settings.acceleration_order = std::atoi(argv[++i]);
+        else if (arg == "--workers" && has_value) settings.timestep_workers = std::atoi(argv[++i]);
+        else if (arg == "--export-threads" && has_value) settings.export_threads = std::atoi(argv[++i]);
+        else return false;
+    }
+    return (settings.acceleration_order == 2 || settings.acceleration_order == 4) &&
+           settings.timestep_workers >= 1 && settings.export_threads >= 0;
+}
+
+int main(int argc, char** argv) {
 
     std::cout << "**************************************************************************\n";
     std::cout << "*  REEF2FAST v3.0 - OpenFAST Input Generator for NHFLOW Wavefields       *\n";
@@ -55,6 +108,16 @@ int main() {
     std::cout << "\n";
     std::cout << "\n";
 
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--batch") return batch_main(argc, argv);
+    }
+
+    CaseSettings settings;
+    if (!parse_run_options(argc, argv, settings)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
     // Ensure output folder exists
     if (!fs::exists("../output")) {
         fs::create_directory("../output");
@@ -118,20 +181,18 @@ int main() {
     }
 
     // Launch the streaming pipeline
+    settings.control_file = "../data/control.txt";
+    settings.ctrl_file = "../data/ctrl.txt";
+    settings.wavefield_file = wavefield_file;
+    settings.output_dir = "../output";
+    settings.is2D = is2D;
+    settings.elevation_mode = elevation_mode;
+    settings.use_wheeler = use_wheeler;
+    settings.write_csv = write_csv;
+    settings.y_total = y_total;
+    settings.ny = ny_usr;
     try {
-        StreamingPipeline pipeline(
-            wavefield_file,
-            "../data/control.txt",
-            "../data/ctrl.txt",
-            is2D,
-            elevation_mode,
-            write_csv,
-            y_total,
-            ny_usr,
-            use_wheeler
-        );
-
-        pipeline.run();
+        run_case(settings);
         std::cout << "\nREEF2FAST pipeline finished successfully.\n";
 
     } catch (const std::exception& e) {
@@ -0,0 +1,39 @@
+#include "mapped_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* map = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // the mapping keeps its own reference
+    if (map == MAP_FAILED) return false;
+
+    data_ = static_cast<const char*>(map);
+    size_ = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) {
+        ::munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+void MappedFile::advise_sequential() const {
+    if (data_) ::madvise(const_cast<char*>(data_), size_, MADV_SEQUENTIAL);
+}
@@ -0,0 +1,126 @@
+#include "output_writer.hpp"
+#include "trace.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <unistd.h>
+
+OutputWriter::OutputWriter(size_t flush_bytes, size_t max_pending_bytes)
+    : flush_bytes(flush_bytes),
+      max_pending_bytes(max_pending_bytes),
+      pending_bytes(0),
+      stopping(false),
+      flusher(&OutputWriter::flush_loop, this) {}
+
+OutputWriter::~OutputWriter() {
+    try {
+        close();
+    } catch (...) {
+        // close() has already been called with the error reported, or the
+        // run is unwinding from another failure
+    }
+}
+
+std::string* OutputWriter::buffer(const std::string& path, bool append) {
+    auto it = files.find(path);
+    if (it != files.end()) return &it->second->text;
+
+    int flags = O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC);
+    int fd = ::open(path.c_str(), flags, 0666);
+    if (fd < 0) return nullptr;
+
+    auto file = std::make_unique<OutputFile>();
+    file->fd = fd;
+    file->path = path;
+    file->text.reserve(flush_bytes + (flush_bytes >> 2));
+    return &files.emplace(path, std::move(file)).first->second->text;
+}
+
+void OutputWriter::commit() {
+    for (auto& [path, file] : files) {
+        if (file->text.size() >= flush_bytes) submit(*file);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (write_error) std::rethrow_exception(write_error);
+}
+
+void OutputWriter::close() {
+    for (auto& [path, file] : files) {
+        if (!file->text.empty()) submit(*file);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    if (flusher.joinable()) flusher.join();
+
+    for (auto& [path, file] : files) ::close(file->fd);
+    files.clear();
+
+    if (write_error) {
+        std::exception_ptr error = write_error;
+        write_error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+// Moves the file's text to the flush queue; the file keeps formatting into a
+// fresh buffer of the same capacity
+void OutputWriter::submit(OutputFile& file) {
+    std::string text;
+    text.reserve(file.text.capacity());
+    text.swap(file.text);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this]() { return pending_bytes < max_pending_bytes; });
+    pending_bytes += text.size();
+    blocks.push_back({&file, std::move(text)});
+    lock.unlock();
+    changed.notify_all();
+}
+
+void OutputWriter::flush_loop() {
+    TRACE_THREAD_NAME("file flush");
+    for (;;) {
+        Block block;
+        bool failed;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this]() { return stopping || !blocks.empty(); });
+            if (blocks.empty()) return;
+            block = std::move(blocks.front());
+            blocks.pop_front();
+
+            // After a failed write the remaining blocks are dropped
+            failed = static_cast<bool>(write_error);
+        }
+
+        TRACE_SPAN("write buffer");
+        const char* data = block.text.data();
+        size_t left = block.text.size();
+        while (!failed && left > 0) {
+            ssize_t n = ::write(block.file->fd, data, left);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                std::lock_guard<std::mutex> lock(mutex);
+                write_error = std::make_exception_ptr(std::runtime_error(
+                    "Could not write " + block.file->path + ": " + std::strerror(errno)));
+                failed = true;
+                break;
+            }
+            data += n;
+            left -= static_cast<size_t>(n);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending_bytes -= block.text.size();
+        }
+        changed.notify_all();
+    }
+}
\ No newline at end of file
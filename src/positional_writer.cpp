@@ -0,0 +1,166 @@
+#include "positional_writer.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+
+// pwrite() of the whole range; false with errno set on failure
+bool pwrite_all(int fd, const char* data, size_t size, off_t offset) {
+    while (size > 0) {
+        ssize_t n = ::pwrite(fd, data, size, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+        offset += n;
+    }
+    return true;
+}
+
+} // namespace
+
+PositionalWriter::PositionalWriter(int num_threads, size_t max_queued_blocks)
+    : max_queued_blocks(std::max<size_t>(1, max_queued_blocks)),
+      num_blocks(0),
+      in_flight(0),
+      stopping(false),
+      num_threads(std::max(1, num_threads)) {}
+
+PositionalWriter::~PositionalWriter() {
+    try {
+        close();
+    } catch (...) {
+        // close() has already been called with the error reported, or the
+        // run is unwinding from another failure
+    }
+}
+
+bool PositionalWriter::add_file(const std::string& path, const std::string& header, size_t block_bytes) {
+    OutputFile file{-1, path, header.size(), block_bytes};
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd >= 0 && !pwrite_all(fd, header.data(), header.size(), 0)) {
+        fail("Could not write " + path + ": " + std::strerror(errno));
+        ::close(fd);
+        fd = -1;
+    }
+    file.fd = fd;
+    files.push_back(file);
+    return fd >= 0;
+}
+
+void PositionalWriter::reserve(size_t num_blocks) {
+    for (const OutputFile& file : files) {
+        if (file.fd < 0) continue;
+        off_t size = static_cast<off_t>(file.header_bytes + num_blocks * file.block_bytes);
+        // Not supported everywhere; the file then simply grows with the writes
+        (void)::posix_fallocate(file.fd, 0, size);
+    }
+}
+
+void PositionalWriter::submit(size_t index, FormatFn format) {
+    // The pool starts with the first block, once the set of files is fixed
+    if (threads.empty()) {
+        for (int i = 0; i < num_threads; ++i) threads.emplace_back(&PositionalWriter::work, this);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this]() { return write_error || jobs.size() + in_flight < max_queued_blocks; });
+    if (write_error) std::rethrow_exception(write_error);
+    jobs.push_back({index, std::move(format)});
+    num_blocks = std::max(num_blocks, index + 1);
+    lock.unlock();
+    changed.notify_all();
+}
+
+void PositionalWriter::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    for (auto& t : threads) t.join();
+    threads.clear();
+
+    for (const OutputFile& file : files) {
+        if (file.fd < 0) continue;
+        off_t size = static_cast<off_t>(file.header_bytes + num_blocks * file.block_bytes);
+        if (!write_error && ::ftruncate(file.fd, size) != 0) {
+            fail("Could not resize " + file.path + ": " + std::strerror(errno));
+        }
+        ::close(file.fd);
+    }
+    files.clear();
+
+    if (write_error) {
+        std::exception_ptr error = write_error;
+        write_error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void PositionalWriter::fail(const std::string& what) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!write_error) write_error = std::make_exception_ptr(std::runtime_error(what));
+}
+
+void PositionalWriter::work() {
+    TRACE_THREAD_NAME("positional writer");
+
+    // Blocks of all files back to back, reused for every job of this thread
+    std::vector<size_t> offsets;
+    size_t total = 0;
+    for (const OutputFile& file : files) {
+        offsets.push_back(total);
+        total += file.block_bytes;
+    }
+    std::vector<char> buffer(total);
+    std::vector<char*> blocks;
+    for (size_t offset : offsets) blocks.push_back(buffer.data() + offset);
+
+    for (;;) {
+        Job job;
+        bool failed;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (jobs.empty()) return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            ++in_flight;
+
+            // After a failed write the remaining blocks are dropped
+            failed = static_cast<bool>(write_error);
+        }
+
+        if (!failed) {
+            try {
+                job.format(blocks.data());
+                TRACE_SPAN("write blocks", static_cast<int>(job.index));
+                for (size_t f = 0; f < files.size(); ++f) {
+                    const OutputFile& file = files[f];
+                    if (file.fd < 0) continue;
+                    off_t offset = static_cast<off_t>(file.header_bytes + job.index * file.block_bytes);
+                    if (!pwrite_all(file.fd, blocks[f], file.block_bytes, offset)) {
+                        fail("Could not write " + file.path + ": " + std::strerror(errno));
+                        break;
+                    }
+                }
+            } catch (const std::exception& e) {
+                fail(e.what());
+            }
+        }
+        job.format = nullptr;   // release the frame before the next block is queued
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --in_flight;
+        }
+        changed.notify_all();
+    }
+}
\ No newline at end of file
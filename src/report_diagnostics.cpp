@@ -4,20 +4,20 @@
 #include <cmath>
 #include <algorithm>
 
-void report_diagnostics_3d(const Wavefield& wf, int timestep) {
+void report_diagnostics_3d(const GridFrame& frame, int timestep) {
     double max_vx = 0.0, max_vy = 0.0, max_vz = 0.0;
     double max_ax = 0.0, max_ay = 0.0, max_az = 0.0;
     double max_p = 0.0, max_eta = 0.0;
 
-    for (const auto& e : wf) {
-        max_vx = std::max(max_vx, std::abs(e.vx));
-        max_vy = std::max(max_vy, std::abs(e.vy));
-        max_vz = std::max(max_vz, std::abs(e.vz));
-        max_ax = std::max(max_ax, std::abs(e.ax));
-        max_ay = std::max(max_ay, std::abs(e.ay));
-        max_az = std::max(max_az, std::abs(e.az));
-        max_p  = std::max(max_p,  std::abs(e.pressure));
-        max_eta = std::max(max_eta, std::abs(e.elevation));
+    for (size_t i = 0; i < frame.size(); ++i) {
+        max_vx = std::max<double>(max_vx, std::abs(frame.vx[i]));
+        max_vy = std::max<double>(max_vy, std::abs(frame.vy[i]));
+        max_vz = std::max<double>(max_vz, std::abs(frame.vz[i]));
+        max_ax = std::max<double>(max_ax, std::abs(frame.ax[i]));
+        max_ay = std::max<double>(max_ay, std::abs(frame.ay[i]));
+        max_az = std::max<double>(max_az, std::abs(frame.az[i]));
+        max_p  = std::max<double>(max_p,  std::abs(frame.pressure[i]));
+        max_eta = std::max<double>(max_eta, std::abs(frame.elevation[i]));
     }
 
     std::cout << "  Max |u|:    " << max_vx << "\n";
@@ -30,18 +30,18 @@ void report_diagnostics_3d(const Wavefield& wf, int timestep) {
     std::cout << "  Max |eta|:  " << max_eta << "\n";
 }
 
-void report_diagnostics_2d(const Wavefield& wf, int timestep) {
+void report_diagnostics_2d(const GridFrame& frame, int timestep) {
     double max_vx = 0.0, max_vz = 0.0;
     double max_ax = 0.0, max_az = 0.0;
     double max_p = 0.0, max_eta = 0.0;
 
-    for (const auto& e : wf) {
-        max_vx = std::max(max_vx, std::abs(e.vx));
-        max_vz = std::max(max_vz, std::abs(e.vz));
-        max_ax = std::max(max_ax, std::abs(e.ax));
-        max_az = std::max(max_az, std::abs(e.az));
-        max_p  = std::max(max_p,  std::abs(e.pressure));
-        max_eta = std::max(max_eta, std::abs(e.elevation));
+    for (size_t i = 0; i < frame.size(); ++i) {
+        max_vx = std::max<double>(max_vx, std::abs(frame.vx[i]));
+        max_vz = std::max<double>(max_vz, std::abs(frame.vz[i]));
+        max_ax = std::max<double>(max_ax, std::abs(frame.ax[i]));
+        max_az = std::max<double>(max_az, std::abs(frame.az[i]));
+        max_p  = std::max<double>(max_p,  std::abs(frame.pressure[i]));
+        max_eta = std::max<double>(max_eta, std::abs(frame.elevation[i]));
     }
 
     std::cout << "  Max |u|:    " << max_vx << "\n";
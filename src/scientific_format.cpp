@@ -0,0 +1,84 @@
+#include "scientific_format.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+// Exact powers of ten (every 10^k with k <= 22 is representable in a double)
+constexpr double POW10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Decimal exponents handled by the fast path: a / 10^(e-4) stays within one
+// correctly rounded multiplication or division by an exact power of ten
+constexpr int MIN_FAST_EXP = -18;
+constexpr int MAX_FAST_EXP = 26;
+
+// Reference path, exact for every double (and for nan/inf/-0)
+char* write_scientific_exact(char* out, double value) {
+#if defined(__cpp_lib_to_chars)
+    return std::to_chars(out, out + MAX_SCIENTIFIC_CHARS, value, std::chars_format::scientific, 4).ptr;
+#else
+    char buf[32];
+    int n = std::snprintf(buf, sizeof(buf), "%.4e", value);
+    for (int i = 0; i < n; ++i) out[i] = buf[i];
+    return out + n;
+#endif
+}
+
+// a * 10^(4 - e), i.e. a scaled to five digits before the decimal point
+inline double scale_to_five_digits(double a, int e) {
+    int k = 4 - e;
+    return (k >= 0) ? a * POW10[k] : a / POW10[-k];
+}
+
+} // namespace
+
+// Fast path: scale to five integer digits with a single rounding error of at
+// most half an ulp (< 1e-11 at this magnitude), then round to an integer. If
+// the fraction is within 1e-9 of a tie the rounding direction is not certain
+// and the exact path decides.
+char* write_scientific(char* out, double value) {
+    double a = std::fabs(value);
+    if (!(a >= 1e-18 && a < 1e26)) return write_scientific_exact(out, value);  // also 0, nan, inf
+
+    // Decimal exponent from the binary one; the estimate is exact or one too low
+    constexpr double LOG10_2 = 0.30102999566398119521;
+    int e = static_cast<int>(std::floor(std::ilogb(a) * LOG10_2));
+    if (e < MIN_FAST_EXP || e > MAX_FAST_EXP) return write_scientific_exact(out, value);
+
+    double scaled = scale_to_five_digits(a, e);
+    if (scaled >= 100000.0) {
+        if (++e > MAX_FAST_EXP) return write_scientific_exact(out, value);
+        scaled = scale_to_five_digits(a, e);
+    }
+
+    double whole = std::floor(scaled);
+    double frac = scaled - whole;
+    if (std::fabs(frac - 0.5) < 1e-9) return write_scientific_exact(out, value);
+
+    unsigned m = static_cast<unsigned>(whole) + (frac > 0.5 ? 1u : 0u);
+    if (m >= 100000) {          // 9.99995... rounds up to 1.0000e(e+1)
+        m /= 10;
+        ++e;
+    }
+    if (m < 10000 || m >= 100000 || e > MAX_FAST_EXP) return write_scientific_exact(out, value);
+
+    char* p = out;
+    if (value < 0) *p++ = '-';
+    p[0] = static_cast<char>('0' + m / 10000);
+    p[1] = '.';
+    p[2] = static_cast<char>('0' + m / 1000 % 10);
+    p[3] = static_cast<char>('0' + m / 100 % 10);
+    p[4] = static_cast<char>('0' + m / 10 % 10);
+    p[5] = static_cast<char>('0' + m % 10);
+    p[6] = 'e';
+    p[7] = (e < 0) ? '-' : '+';
+    unsigned ue = static_cast<unsigned>(e < 0 ? -e : e);
+    p[8] = static_cast<char>('0' + ue / 10);
+    p[9] = static_cast<char>('0' + ue % 10);
+    return p + 10;
+}
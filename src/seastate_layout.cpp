@@ -0,0 +1,196 @@
+#include "seastate_layout.hpp"
+#include "common.hpp"
+#include "scientific_format.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <set>
+
+namespace {
+
+// Splits the sorted index list into value rows of equal key; returns the row
+// starts plus the end
+template <typename Key>
+std::vector<size_t> split_rows(const std::vector<size_t>& order, Key key) {
+    std::vector<size_t> begin;
+    for (size_t k = 0; k < order.size(); ++k) {
+        if (k == 0 || key(order[k]) != key(order[k - 1])) begin.push_back(k);
+    }
+    begin.push_back(order.size());
+    return begin;
+}
+
+std::string kinematics_label(double y, double z) {
+    std::string label = "! All X values at Y = ";
+    append_scientific(label, y);
+    label += ", Z = ";
+    append_scientific(label, z);
+    label += ", Time = ";
+    return label;
+}
+
+std::string elevation_label(double y) {
+    std::string label = "! Y = ";
+    append_scientific(label, y);
+    label += ", Time = ";
+    return label;
+}
+
+// Rounded y of the slices in output order
+std::vector<double> rounded_slices(const std::vector<double>& y_slices) {
+    std::vector<double> y;
+    for (double v : y_slices) y.push_back(round_to(v));
+    std::sort(y.begin(), y.end());
+    return y;
+}
+
+// y_slices == nullptr: 3D grid, otherwise the 2D grid broadcast to these slices
+void plan_kinematics(const GridGeometry& grid, const std::vector<double>* y_slices, SeaStateLayout& layout) {
+    std::set<double> x_coords(grid.x.begin(), grid.x.end());
+    std::set<double> y_coords = y_slices ? std::set<double>(y_slices->begin(), y_slices->end())
+                                         : std::set<double>(grid.y.begin(), grid.y.end());
+    std::set<double> z_coords(grid.z.begin(), grid.z.end());
+
+    layout.kinematics_valid = x_coords.size() >= 2 && y_coords.size() >= 2 && z_coords.size() >= 2;
+    if (layout.kinematics_valid) {
+        double dx = *std::next(x_coords.begin()) - *x_coords.begin();
+        double dy = *std::next(y_coords.begin()) - *y_coords.begin();
+        double z_max = *z_coords.rbegin();
+        double dthetaZ = M_PI / (2.0 * (z_coords.size() - 1));
+
+        std::string& h = layout.kinematics_header;
+        h += "! " + format_scientific(layout.wave_dt) + "  - WaveDT (s)\n";
+        h += "! " + std::to_string(x_coords.size()) + "  - NX*2 - 1\n";
+        h += "! " + std::to_string(y_coords.size()) + "  - NY*2 - 1\n";
+        h += "! " + std::to_string(z_coords.size()) + "  - NZ\n";
+        h += "! " + format_scientific(dx) + "  - dX (m)\n";
+        h += "! " + format_scientific(dy) + "  - dY (m)\n";
+        h += "! " + format_scientific(z_max) + "  - Z_Depth (m)\n";
+        h += "! " + format_scientific(dthetaZ) + "  - dthetaZ (rad)\n";
+        h += "! "; for (const auto& x : x_coords) h += format_scientific(x) + " "; h += "- X-Locations (m)\n";
+        h += "! "; for (const auto& y : y_coords) h += format_scientific(y) + " "; h += "- Y-Locations (m)\n";
+        h += "! "; for (const auto& z : z_coords) h += format_scientific(z) + " "; h += "- Z-Locations (m)\n";
+    }
+
+    // Value rows by rounded (z, y), or by z alone when broadcast; the stable
+    // sort keeps grid order within a row
+    std::vector<double> z(grid.size()), y(grid.size(), 0.0);
+    for (size_t i = 0; i < grid.size(); ++i) {
+        z[i] = round_to(grid.z[i]);
+        if (!y_slices) y[i] = round_to(grid.y[i]);
+    }
+    layout.order.resize(grid.size());
+    std::iota(layout.order.begin(), layout.order.end(), size_t{0});
+    std::stable_sort(layout.order.begin(), layout.order.end(), [&](size_t a, size_t b) {
+        return (z[a] != z[b]) ? z[a] < z[b] : y[a] < y[b];
+    });
+    layout.row_begin = split_rows(layout.order, [&](size_t i) { return std::make_pair(z[i], y[i]); });
+
+    const size_t value_rows = layout.row_begin.size() - 1;
+    const std::vector<double> slices = y_slices ? rounded_slices(*y_slices) : std::vector<double>();
+    for (size_t v = 0; v < value_rows; ++v) {
+        const size_t first = layout.order[layout.row_begin[v]];
+        if (!y_slices) {
+            layout.row_source.push_back(v);
+            layout.row_label.push_back(kinematics_label(y[first], z[first]));
+            continue;
+        }
+        for (double ys : slices) {
+            layout.row_source.push_back(v);
+            layout.row_label.push_back(kinematics_label(ys, z[first]));
+        }
+    }
+}
+
+void plan_elevation(const GridGeometry& grid, const std::vector<double>* y_slices, SeaStateLayout& layout) {
+    std::set<double> x_coords, y_coords;
+    std::vector<double> x(grid.size()), y(grid.size(), 0.0);
+    for (size_t i = 0; i < grid.size(); ++i) {
+        if (round_to(grid.z[i]) != 0.0) continue;
+        x[i] = round_to(grid.x[i]);
+        x_coords.insert(x[i]);
+        if (!y_slices) {
+            y[i] = round_to(grid.y[i]);
+            y_coords.insert(y[i]);
+        }
+        layout.surface_order.push_back(i);
+    }
+
+    const std::vector<double> slices = y_slices ? rounded_slices(*y_slices) : std::vector<double>();
+    if (y_slices && !layout.surface_order.empty()) y_coords.insert(slices.begin(), slices.end());
+
+    layout.elevation_valid = x_coords.size() >= 2 && y_coords.size() >= 2;
+    if (layout.elevation_valid) {
+        double dx = *std::next(x_coords.begin()) - *x_coords.begin();
+        double dy = *std::next(y_coords.begin()) - *y_coords.begin();
+
+        std::string& h = layout.elevation_header;
+        h += "This surface elevation file was generated by REEF2FAST\n";
+        h += "Surface elevation relative to still water level (m)\n";
+        h += "! " + format_scientific(layout.wave_dt) + "  - WaveDT (s)\n";
+        h += "! " + std::to_string(x_coords.size()) + "  - NX*2 - 1\n";
+        h += "! " + std::to_string(y_coords.size()) + "  - NY*2 - 1\n";
+        h += "! " + format_scientific(dx) + "  - dX (m)\n";
+        h += "! " + format_scientific(dy) + "  - dY (m)\n";
+        h += "!\n!\n!\n!\n";
+        h += "! "; for (const auto& v : x_coords) h += format_scientific(v) + " "; h += "- X positions\n";
+        h += "! "; for (const auto& v : y_coords) h += format_scientific(v) + " "; h += "- Y positions\n";
+    }
+
+    if (layout.surface_order.empty()) return;
+
+    // Value rows by rounded y (a single row when broadcast), sorted by rounded x
+    std::stable_sort(layout.surface_order.begin(), layout.surface_order.end(), [&](size_t a, size_t b) {
+        return (y[a] != y[b]) ? y[a] < y[b] : x[a] < x[b];
+    });
+    layout.surface_row_begin = split_rows(layout.surface_order, [&](size_t i) { return y[i]; });
+
+    const size_t value_rows = layout.surface_row_begin.size() - 1;
+    for (size_t v = 0; v < value_rows; ++v) {
+        if (!y_slices) {
+            layout.surface_row_source.push_back(v);
+            layout.surface_row_label.push_back(elevation_label(y[layout.surface_order[layout.surface_row_begin[v]]]));
+            continue;
+        }
+        for (double ys : slices) {
+            layout.surface_row_source.push_back(v);
+            layout.surface_row_label.push_back(elevation_label(ys));
+        }
+    }
+}
+
+} // namespace
+
+SeaStateLayout plan_seastate_layout(const GridGeometry& grid, double wave_dt) {
+    SeaStateLayout layout;
+    layout.grid = &grid;
+    layout.wave_dt = wave_dt;
+    plan_kinematics(grid, nullptr, layout);
+    plan_elevation(grid, nullptr, layout);
+    return layout;
+}
+
+SeaStateLayout plan_seastate_layout_y_broadcast(const GridGeometry& grid,
+                                                const std::vector<double>& y_slices,
+                                                double wave_dt) {
+    SeaStateLayout layout;
+    layout.grid = &grid;
+    layout.wave_dt = wave_dt;
+    plan_kinematics(grid, &y_slices, layout);
+    plan_elevation(grid, &y_slices, layout);
+
+    // Text of a zero vy / ay row, as long as the longest value row
+    size_t longest = 0;
+    for (size_t v = 0; v + 1 < layout.row_begin.size(); ++v) {
+        longest = std::max(longest, layout.row_begin[v + 1] - layout.row_begin[v]);
+    }
+    char zero[MAX_SCIENTIFIC_CHARS];
+    const std::string token(zero, write_scientific(zero, 0.0));
+    const std::string padded(zero, write_scientific_padded(zero, 0.0));
+    layout.transverse_zero = true;
+    for (size_t k = 0; k < longest; ++k) {
+        layout.zero_row += token + ' ';
+        layout.zero_row_padded += padded + ' ';
+    }
+    return layout;
+}
\ No newline at end of file
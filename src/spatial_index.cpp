@@ -0,0 +1,262 @@
+#include "spatial_index.hpp"
+#include "trace.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+#include <omp.h>
+
+#include "../external/nanoflann.hpp"
+
+namespace {
+
+template <int DIM>
+struct IndexCloud {
+    std::vector<std::array<double, DIM>> pts;
+
+    inline size_t kdtree_get_point_count() const { return pts.size(); }
+    inline double kdtree_get_pt(const size_t idx, const size_t dim) const { return pts[idx][dim]; }
+    template <class BBOX> bool kdtree_get_bbox(BBOX&) const { return false; }
+};
+
+template <int DIM>
+using IndexTree = nanoflann::KDTreeSingleIndexAdaptor<
+    nanoflann::L2_Simple_Adaptor<double, IndexCloud<DIM>>,
+    IndexCloud<DIM>,
+    DIM
+>;
+
+// Position of a point in index space: (x, y, z) in 3D, (x, z) in 2D
+template <int DIM> std::array<double, DIM> index_coords(double x, double y, double z);
+template <> std::array<double, 3> index_coords<3>(double x, double y, double z) { return {x, y, z}; }
+template <> std::array<double, 2> index_coords<2>(double x, double, double z) { return {x, z}; }
+
+// kNN result set over base tree + overlay tree: base points that have moved are
+// dropped, overlay indices are mapped back to raw point indices
+class MaskedKNNResultSet : public nanoflann::KNNResultSet<double> {
+public:
+    MaskedKNNResultSet(size_t k, const std::vector<uint8_t>& moved, const std::vector<size_t>& moved_ids)
+        : nanoflann::KNNResultSet<double>(k), moved(moved), moved_ids(moved_ids), in_overlay(false) {}
+
+    void search_overlay() { in_overlay = true; }
+
+    bool addPoint(double dist, size_t index) {
+        if (in_overlay) index = moved_ids[index];
+        else if (moved[index]) return true;
+        return nanoflann::KNNResultSet<double>::addPoint(dist, index);
+    }
+
+private:
+    const std::vector<uint8_t>& moved;
+    const std::vector<size_t>& moved_ids;
+    bool in_overlay;
+};
+
+enum class IndexUpdate { Rebuilt, Partial, Reused };
+
+template <int DIM>
+class IndexState {
+public:
+    explicit IndexState(int k) : k(k), targets_seen(nullptr), cached_valid(false) {}
+
+    IndexUpdate update(const Wavefield& raw,
+                       const std::vector<std::array<double, 3>>& targets,
+                       NeighbourList& neighbours) {
+        const bool same_targets = (&targets == targets_seen) && neighbours.num_targets() == targets.size();
+        targets_seen = &targets;
+
+        IndexUpdate update = refit(raw);
+        if (update == IndexUpdate::Reused && same_targets && cached_valid) return IndexUpdate::Reused;
+
+        search(targets, neighbours);
+        cached_valid = true;
+        return (update == IndexUpdate::Reused) ? IndexUpdate::Partial : update;
+    }
+
+    // kNN of other targets into out; the cached list of update() is kept
+    // unless the tree changed
+    IndexUpdate search_into(const Wavefield& raw,
+                            const std::vector<std::array<double, 3>>& targets,
+                            NeighbourList& out) {
+        IndexUpdate update = refit(raw);
+        if (update != IndexUpdate::Reused) cached_valid = false;
+        search(targets, out);
+        return update;
+    }
+
+private:
+    // Brings the trees to the coordinates of raw: Reused if nothing moved
+    // since the last call, Partial if only the overlay was rebuilt
+    IndexUpdate refit(const Wavefield& raw) {
+        TRACE_SPAN("index refit");
+        const size_t n = raw.size();
+        if (!base_tree || n != base.pts.size()) {
+            rebuild(raw);
+            return IndexUpdate::Rebuilt;
+        }
+
+        // Which points differ from the coordinates the base tree was built from?
+        scratch_ids.clear();
+        for (size_t i = 0; i < n; ++i) {
+            if (index_coords<DIM>(raw[i].x, raw[i].y, raw[i].z) != base.pts[i]) scratch_ids.push_back(i);
+        }
+
+        // Beyond a quarter of the points two queries per target cost more than a rebuild
+        if (scratch_ids.size() > n / 4) {
+            rebuild(raw);
+            return IndexUpdate::Rebuilt;
+        }
+
+        if (scratch_ids == moved_ids && overlay_matches(raw)) return IndexUpdate::Reused;
+
+        // Refit: only the moved points are indexed again
+        for (size_t i : moved_ids) moved[i] = 0;
+        moved_ids.swap(scratch_ids);
+        for (size_t i : moved_ids) moved[i] = 1;
+
+        overlay.pts.resize(moved_ids.size());
+        for (size_t j = 0; j < moved_ids.size(); ++j) {
+            const auto& e = raw[moved_ids[j]];
+            overlay.pts[j] = index_coords<DIM>(e.x, e.y, e.z);
+        }
+        overlay_tree.reset();
+        if (!overlay.pts.empty()) {
+            overlay_tree = std::make_unique<IndexTree<DIM>>(DIM, overlay, nanoflann::KDTreeSingleIndexAdaptorParams(10));
+        }
+        return IndexUpdate::Partial;
+    }
+
+    void rebuild(const Wavefield& raw) {
+        TRACE_SPAN("index rebuild");
+        base.pts.resize(raw.size());
+        for (size_t i = 0; i < raw.size(); ++i) {
+            base.pts[i] = index_coords<DIM>(raw[i].x, raw[i].y, raw[i].z);
+        }
+
+        // The nanoflann constructor builds the tree, no extra buildIndex() needed
+        base_tree.reset();
+        if (!base.pts.empty()) {
+            base_tree = std::make_unique<IndexTree<DIM>>(DIM, base, nanoflann::KDTreeSingleIndexAdaptorParams(10));
+        }
+
+        moved.assign(raw.size(), 0);
+        moved_ids.clear();
+        overlay.pts.clear();
+        overlay_tree.reset();
+    }
+
+    bool overlay_matches(const Wavefield& raw) const {
+        for (size_t j = 0; j < moved_ids.size(); ++j) {
+            const auto& e = raw[moved_ids[j]];
+            if (index_coords<DIM>(e.x, e.y, e.z) != overlay.pts[j]) return false;
+        }
+        return true;
+    }
+
+    void search(const std::vector<std::array<double, 3>>& targets, NeighbourList& neighbours) const {
+        neighbours.k = k;
+        neighbours.indices.resize(targets.size() * k);
+        neighbours.dists.resize(targets.size() * k);
+        neighbours.count.assign(targets.size(), 0);
+
+        if (!base_tree) return;
+
+        // eps = 0: exact kNN. An approximate search would depend on the tree
+        // layout and give different neighbours after a partial update.
+        const nanoflann::SearchParameters exact(0.0f);
+
+        #pragma omp parallel
+        {
+            TRACE_SPAN("kNN search");   // per thread: shows the load balance
+
+            #pragma omp for schedule(static) nowait
+            for (int i = 0; i < static_cast<int>(targets.size()); ++i) {
+                const auto& pt = targets[i];
+                auto query = index_coords<DIM>(pt[0], pt[1], pt[2]);
+                size_t* indices = &neighbours.indices[static_cast<size_t>(i) * k];
+                double* dists = &neighbours.dists[static_cast<size_t>(i) * k];
+
+                if (moved_ids.empty()) {
+                    nanoflann::KNNResultSet<double> resultSet(k);
+                    resultSet.init(indices, dists);
+                    base_tree->findNeighbors(resultSet, query.data(), exact);
+                    neighbours.count[i] = static_cast<int>(resultSet.size());
+                } else {
+                    MaskedKNNResultSet resultSet(k, moved, moved_ids);
+                    resultSet.init(indices, dists);
+                    base_tree->findNeighbors(resultSet, query.data(), exact);
+                    resultSet.search_overlay();
+                    overlay_tree->findNeighbors(resultSet, query.data(), exact);
+                    neighbours.count[i] = static_cast<int>(resultSet.size());
+                }
+            }
+        }
+    }
+
+    int k;
+
+    // Coordinates the base tree was built from
+    IndexCloud<DIM> base;
+    std::unique_ptr<IndexTree<DIM>> base_tree;
+
+    // Points that moved since the base build, indexed separately
+    std::vector<uint8_t> moved;
+    std::vector<size_t> moved_ids;
+    std::vector<size_t> scratch_ids;
+    IndexCloud<DIM> overlay;
+    std::unique_ptr<IndexTree<DIM>> overlay_tree;
+
+    // Targets of the cached neighbour list, and whether it matches the trees
+    const std::vector<std::array<double, 3>>* targets_seen;
+    bool cached_valid;
+};
+
+void count_update(IndexUpdate update, size_t& rebuilds, size_t& partial_updates, size_t& reused) {
+    switch (update) {
+        case IndexUpdate::Rebuilt: ++rebuilds; break;
+        case IndexUpdate::Partial: ++partial_updates; break;
+        case IndexUpdate::Reused:  ++reused; break;
+    }
+}
+
+} // namespace
+
+struct SpatialIndex::Impl {
+    Impl(int dims, int k) : dims(dims), plane(k), space(k) {}
+
+    int dims;
+    IndexState<2> plane;
+    IndexState<3> space;
+    NeighbourList neighbours;
+};
+
+SpatialIndex::SpatialIndex(int dims, int k)
+    : impl(std::make_unique<Impl>(dims, k)),
+      rebuilds(0),
+      partial_updates(0),
+      reused(0)
+{
+    if (dims != 2 && dims != 3) throw std::invalid_argument("SpatialIndex: dims must be 2 or 3");
+    if (k < 1 || k > MAX_NEIGHBOURS) throw std::invalid_argument("SpatialIndex: k out of range");
+}
+
+SpatialIndex::~SpatialIndex() = default;
+
+const NeighbourList& SpatialIndex::query(const Wavefield& raw,
+                                         const std::vector<std::array<double, 3>>& targets) {
+    IndexUpdate update = (impl->dims == 2)
+        ? impl->plane.update(raw, targets, impl->neighbours)
+        : impl->space.update(raw, targets, impl->neighbours);
+
+    count_update(update, rebuilds, partial_updates, reused);
+    return impl->neighbours;
+}
+
+void SpatialIndex::search(const Wavefield& raw,
+                          const std::vector<std::array<double, 3>>& targets,
+                          NeighbourList& out) {
+    IndexUpdate update = (impl->dims == 2)
+        ? impl->plane.search_into(raw, targets, out)
+        : impl->space.search_into(raw, targets, out);
+
+    count_update(update, rebuilds, partial_updates, reused);
+}
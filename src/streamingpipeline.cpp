@@ -6,10 +6,7 @@
 #include "cloud2d.hpp"
 #include "acc.hpp"
 #include "acc2d.hpp"
-#include "elevation_geo.hpp"
-#include "elevation_geo2d.hpp"
-#include "elevation_elev.hpp"
-#include "elevation_elev2d.hpp"
+#include "surface_elevation.hpp"
 #include "export.hpp"
 #include "export_elevation.hpp"
 #include "write_out.hpp"
@@ -17,10 +14,147 @@
 #include "genSeaState.hpp"
 #include "report_diagnostics.hpp"
 #include "wheeler.hpp"
+#include "idw_kernel.hpp"
+#include "spsc_queue.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 // The brain of the programme. The timestep-streaming architecture.
 
+// Raw (prev, curr, next) window handed from the reader to the compute stage.
+// The frames are the stream's own buffers, so no raw frame is copied; a buffer
+// is reused by the stream once the last window holding it is released.
+// prev2 and next2 are only filled for the five-point acceleration stencil.
+struct StreamingPipeline::RawWindow {
+    int timestep = 0;
+    std::shared_ptr<const Wavefield> prev2, prev, curr, next, next2;
+};
+
+// Finished timestep handed from the compute to the writer stage
+struct StreamingPipeline::ExportJob {
+    int timestep = 0;
+    GridFrame frame;
+};
+
+namespace {
+
+// Worker threads for the per-window part of the compute stage. Every worker owns
+// its spatial index (a static grid is indexed once per worker) and gets an
+// equal share of the OpenMP threads for the per-point loops inside a frame.
+class FrameWorkers {
+public:
+    using FrameFn = std::function<GridFrame(SpatialIndex&)>;
+
+    FrameWorkers(int num_workers, int dims) : stopping(false) {
+        int omp_threads = 1;
+#ifdef _OPENMP
+        omp_threads = std::max(1, omp_get_max_threads() / num_workers);
+#endif
+        for (int w = 0; w < num_workers; ++w) {
+            raw_indices.push_back(std::make_unique<SpatialIndex>(dims, 4));
+        }
+        for (int w = 0; w < num_workers; ++w) {
+            threads.emplace_back([this, w, omp_threads]() { work(w, omp_threads); });
+        }
+    }
+
+    ~FrameWorkers() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    std::future<GridFrame> submit(FrameFn fn) {
+        Job job{std::move(fn), {}};
+        std::future<GridFrame> result = job.result.get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+        }
+        wake.notify_one();
+        return result;
+    }
+
+    // Statistics of the workers' raw-frame indices
+    size_t num_rebuilds() const { return sum(&SpatialIndex::num_rebuilds); }
+    size_t num_partial_updates() const { return sum(&SpatialIndex::num_partial_updates); }
+    size_t num_reused() const { return sum(&SpatialIndex::num_reused); }
+
+private:
+    struct Job {
+        FrameFn fn;
+        std::promise<GridFrame> result;
+    };
+
+    void work(int w, int omp_threads) {
+        TRACE_THREAD_NAME("frame worker " + std::to_string(w));
+#ifdef _OPENMP
+        omp_set_num_threads(omp_threads);
+#else
+        (void)omp_threads;
+#endif
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return stopping || !jobs.empty(); });
+                if (jobs.empty()) return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            try {
+                job.result.set_value(job.fn(*raw_indices[w]));
+            } catch (...) {
+                job.result.set_exception(std::current_exception());
+            }
+        }
+    }
+
+    size_t sum(size_t (SpatialIndex::*counter)() const) const {
+        size_t total = 0;
+        for (const auto& index : raw_indices) total += (index.get()->*counter)();
+        return total;
+    }
+
+    std::vector<std::unique_ptr<SpatialIndex>> raw_indices;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Job> jobs;
+    bool stopping;
+};
+
+// Thrown inside the reader callback to leave the stream once the pipeline is cancelled
+struct PipelineCancelled {};
+
+// Queue depths: the reader runs at most two windows ahead of compute,
+// compute at most two frames ahead of the writer
+constexpr size_t RAW_QUEUE_DEPTH = 2;
+constexpr size_t EXPORT_QUEUE_DEPTH = 2;
+
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+} // namespace
+
 StreamingPipeline::StreamingPipeline(const std::string& wavefield_file,
                                      const std::string& control_file,
                                      const std::string& ctrl_txt,
@@ -29,7 +163,12 @@ StreamingPipeline::StreamingPipeline(const std::string& wavefield_file,
                                      bool write_csv,
                                      double y_total,
                                      int ny_usr,
-                                     bool use_wheeler)
+                                     bool use_wheeler,
+                                     bool use_frame_cache,
+                                     int timestep_workers,
+                                     int export_threads,
+                                     int acceleration_order,
+                                     const std::string& output_dir)
     : wavefield_file(wavefield_file),
       control_file(control_file),
       ctrl_txt(ctrl_txt),
@@ -39,9 +178,24 @@ StreamingPipeline::StreamingPipeline(const std::string& wavefield_file,
       y_total(y_total),
       ny_usr(ny_usr),
       use_wheeler(use_wheeler),
+      use_frame_cache(use_frame_cache),
+      timestep_workers(std::max(1, timestep_workers)),
+      export_threads(std::max(0, export_threads)),
+      acceleration_order(acceleration_order == 4 ? 4 : 2),
+      output_dir(output_dir),
       grid_reported(false),
       seastate_written(false),
-      first_elevation_written(false) {}
+      first_elevation_written(false),
+      raw_index(is2D ? 2 : 3, 4),
+      surface_elevation(is2D ? 1 : 2, elevation_mode == "z" ? SurfaceElevation::Source::GEOMETRIC
+                                                            : SurfaceElevation::Source::REEF3D),
+      wheeler_surface(is2D ? 1 : 2, SurfaceElevation::Source::REEF3D),
+      positional_wavefiles(false),
+      positional_elevation(false),
+      blocks_submitted(0),
+      index_rebuilds(0),
+      index_partial_updates(0),
+      index_reused(0) {}
 
 void StreamingPipeline::run() {
     // Generate target interpolation grid
@@ -50,6 +204,16 @@ void StreamingPipeline::run() {
     }else {
     generate_seastate_grid_targets(control_file, target_grid);
     }
+
+    // Grid coordinates are stored once; interpolated frames only hold values
+    grid.x.resize(target_grid.size());
+    grid.y.resize(target_grid.size());
+    grid.z.resize(target_grid.size());
+    for (size_t i = 0; i < target_grid.size(); ++i) {
+        grid.x[i] = target_grid[i][0];
+        grid.y[i] = target_grid[i][1];
+        grid.z[i] = target_grid[i][2];
+    }
     
     // Read grid bounds
     if (!read_control_file(control_file, X_MIN, X_MAX, Y_MIN, Y_MAX, Z_MIN, Z_MAX, NX, NY, NZ)) {
@@ -60,6 +224,7 @@ void StreamingPipeline::run() {
         Y_MIN = -y_total;
         Y_MAX =  y_total;
         NY = ny_usr;
+        y_slices = inflate_slices_y(y_total, ny_usr);
     }
 
     // Optional console report
@@ -86,125 +251,439 @@ void StreamingPipeline::run() {
     }
 
     generate_seastate(X_MIN, X_MAX, Y_MIN, Y_MAX, Z_MIN, Z_MAX,
-                      NX, NY, NZ, wave_tmax, wave_dt, wave_hs, wave_tp);
+                      NX, NY, NZ, wave_tmax, wave_dt, wave_hs, wave_tp, output_dir);
     seastate_written = true;
 
-    std::cout << "\nStreaming and interpolating REEF3D wavefield...\n";
+    // Row order and headers of the SeaState files, fixed for the whole run
+    seastate_layout = is2D ? plan_seastate_layout_y_broadcast(grid, y_slices, wave_dt)
+                           : plan_seastate_layout(grid, wave_dt);
+    if (export_threads > 0) open_positional_output();
 
-    if (is2D) {
-        stream_wavefield_with_context_2d(wavefield_file, z_max,
-            [&](int t,
-                const std::vector<WavefieldEntry>& prev,
-                const std::vector<WavefieldEntry>& curr,
-                const std::vector<WavefieldEntry>& next) {
-                process_timestep(t, prev, curr, next);
-            });
-    } else {
-        stream_wavefield_with_context(wavefield_file, z_max,
-            [&](int t,
-                const std::vector<WavefieldEntry>& prev,
-                const std::vector<WavefieldEntry>& curr,
-                const std::vector<WavefieldEntry>& next) {
-                process_timestep(t, prev, curr, next);
+    std::cout << "\nStreaming and interpolating REEF3D wavefield (IDW kernel: " << idw::kernel_isa() << ")...\n";
+
+    // Reader -> compute -> writer: ingest of step t+2, interpolation of t+1 and
+    // export of t overlap. Every stage reports its first error and closes both
+    // queues, so the other stages stop too.
+    SpscQueue<RawWindow> raw_queue(RAW_QUEUE_DEPTH);
+    SpscQueue<ExportJob> export_queue(EXPORT_QUEUE_DEPTH);
+    std::exception_ptr reader_error, compute_error, writer_error;
+    times = StageTimes();
+    target_frames.clear();
+    const Clock::time_point run_start = Clock::now();
+
+    auto cancel = [&]() {
+        raw_queue.close();
+        export_queue.close();
+    };
+
+    std::thread reader([&]() {
+        TRACE_THREAD_NAME("reader");
+        const Clock::time_point start = Clock::now();
+        try {
+            // The five-point stencil also needs next2, known one window later
+            RawWindow held;
+            bool holding = false;
+            auto emit = [&](RawWindow window) {
+                if (acceleration_order == 4) {
+                    if (!holding) {
+                        held = std::move(window);
+                        holding = true;
+                        return;
+                    }
+                    window.prev2 = held.prev;
+                    held.next2 = window.next;
+                    std::swap(held, window);
+                }
+                if (!raw_queue.push(std::move(window))) throw PipelineCancelled();
+            };
+
+            stream_raw_frames([&](int t, const SharedFrame& prev, const SharedFrame& curr, const SharedFrame& next) {
+                TRACE_SPAN("hand over window", t);
+                RawWindow window;
+                window.timestep = t;
+                window.prev = prev;
+                window.curr = curr;
+                window.next = next;
+                emit(std::move(window));
             });
+            if (holding && !raw_queue.push(std::move(held))) throw PipelineCancelled();
+            raw_queue.close();
+        } catch (const PipelineCancelled&) {
+        } catch (...) {
+            reader_error = std::current_exception();
+            cancel();
+        }
+        times.ingest = seconds_since(start) - raw_queue.push_wait_seconds();
+    });
+
+    std::thread writer([&]() {
+        TRACE_THREAD_NAME("writer");
+        const Clock::time_point start = Clock::now();
+        try {
+            ExportJob job;
+            while (export_queue.pop(job)) {
+                write_timestep(job.timestep, std::move(job.frame));
+                ++times.timesteps;
+            }
+            if (positional) positional->close();
+            output.close();
+        } catch (...) {
+            writer_error = std::current_exception();
+            cancel();
+        }
+        times.write = seconds_since(start) - export_queue.pop_wait_seconds();
+    });
+
+    // Compute stage in this thread
+    TRACE_THREAD_NAME("compute");
+    const Clock::time_point compute_start = Clock::now();
+    try {
+        if (timestep_workers > 1) compute_timesteps_parallel(raw_queue, export_queue);
+        else compute_timesteps(raw_queue, export_queue);
+        export_queue.close();
+    } catch (...) {
+        compute_error = std::current_exception();
+        cancel();
     }
+    times.compute = seconds_since(compute_start) - raw_queue.pop_wait_seconds() - export_queue.push_wait_seconds();
+
+    reader.join();
+    writer.join();
+    times.total = seconds_since(run_start);
+
+    if (reader_error) std::rethrow_exception(reader_error);
+    if (compute_error) std::rethrow_exception(compute_error);
+    if (writer_error) std::rethrow_exception(writer_error);
+
+    std::cout << "\nSpatial index: " << index_rebuilds << " rebuilds, "
+              << index_partial_updates << " partial updates, "
+              << index_reused << " reused\n";
+    std::cout << "Surface elevation: " << surface_elevation.num_plans() << " column plans\n";
+    std::cout << "Stage times: ingest " << times.ingest << " s, compute " << times.compute
+              << " s, write " << times.write << " s (wall " << times.total << " s)\n";
 
     std::cout << "\nAll timesteps processed successfully.\n";
 }
 
+// The frame is interpolated outside the lock; timesteps that need it meanwhile
+// wait on the shared future
+std::shared_future<GridFrame> StreamingPipeline::TargetFrames::get(int frame,
+                                                                   const std::function<GridFrame()>& interpolate) {
+    std::promise<GridFrame> promise;
+    std::shared_future<GridFrame> result;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = frames.find(frame);
+        if (it != frames.end()) return it->second;
+        result = promise.get_future().share();
+        frames.emplace(frame, result);
+    }
+    try {
+        promise.set_value(interpolate());
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+    return result;
+}
+
+void StreamingPipeline::TargetFrames::drop_before(int frame) {
+    std::lock_guard<std::mutex> lock(mutex);
+    frames.erase(frames.begin(), frames.lower_bound(frame));
+}
+
+void StreamingPipeline::TargetFrames::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    frames.clear();
+}
+
+AccelerationFrames StreamingPipeline::stencil_frames(const RawWindow& window) {
+    AccelerationFrames frames;
+    frames.prev2 = window.prev2.get();
+    frames.prev = window.prev.get();
+    frames.curr = window.curr.get();
+    frames.next = window.next.get();
+    frames.next2 = window.next2.get();
+    return frames;
+}
+
+void StreamingPipeline::compute_timesteps(SpscQueue<RawWindow>& raw_queue, SpscQueue<ExportJob>& export_queue) {
+    RawWindow window;
+    while (raw_queue.pop(window)) {
+        ExportJob job;
+        job.timestep = window.timestep;
+        job.frame = compute_timestep(window.timestep, stencil_frames(window));
+        target_frames.drop_before(window.timestep - 1);
+        if (!export_queue.push(std::move(job))) break;
+    }
+
+    index_rebuilds += raw_index.num_rebuilds();
+    index_partial_updates += raw_index.num_partial_updates();
+    index_reused += raw_index.num_reused();
+}
+
+// Interpolation, acceleration, Wheeler stretching and elevation only depend on
+// the raw frames of one window, so they run on the workers for up to
+// timestep_workers windows ahead. Diagnostics are done here in timestep order
+// before the frame goes to the writer.
+void StreamingPipeline::compute_timesteps_parallel(SpscQueue<RawWindow>& raw_queue, SpscQueue<ExportJob>& export_queue) {
+    struct PendingWindow {
+        int timestep;
+        std::future<GridFrame> frame;
+    };
+
+    FrameWorkers workers(timestep_workers, is2D ? 2 : 3);
+    std::deque<PendingWindow> pending;
+    RawWindow window;
+
+    // Ordered commit of the oldest window; false once the writer has stopped
+    auto commit = [&]() {
+        PendingWindow& w = pending.front();
+        GridFrame frame = w.frame.get();
+
+        ExportJob job;
+        job.timestep = w.timestep;
+        job.frame = finish_timestep(w.timestep, frame);
+        target_frames.drop_before(w.timestep - 1);
+        pending.pop_front();
+        return export_queue.push(std::move(job));
+    };
+
+    bool writing = true;
+    while (writing && raw_queue.pop(window)) {
+        // The job keeps the window's raw frames alive until it is done
+        auto raw = std::make_shared<const RawWindow>(std::move(window));
+        PendingWindow w;
+        w.timestep = raw->timestep;
+        w.frame = workers.submit([this, raw](SpatialIndex& index) {
+            return compute_frame(raw->timestep, stencil_frames(*raw), index);
+        });
+        pending.push_back(std::move(w));
+
+        if (pending.size() > static_cast<size_t>(timestep_workers)) writing = commit();
+    }
+    while (writing && !pending.empty()) writing = commit();
+
+    index_rebuilds += workers.num_rebuilds();
+    index_partial_updates += workers.num_partial_updates();
+    index_reused += workers.num_reused();
+}
+
+// Feeds the (prev, curr, next) windows of the wavefield CSV to callback
+void StreamingPipeline::stream_raw_frames(const SharedFrameCallback& callback) {
+    if (is2D) {
+        stream_wavefield_frames_2d(wavefield_file, z_max, callback, use_frame_cache);
+    } else {
+        stream_wavefield_frames(wavefield_file, z_max, callback, use_frame_cache);
+    }
+}
+
 void StreamingPipeline::process_timestep(int timestep,
     const std::vector<WavefieldEntry>& prev,
     const std::vector<WavefieldEntry>& curr,
     const std::vector<WavefieldEntry>& next) {
+    AccelerationFrames frames;
+    frames.prev = &prev;
+    frames.curr = &curr;
+    frames.next = &next;
+    target_frames.clear();
+    write_timestep(timestep, compute_timestep(timestep, frames));
+}
 
-    std::cout << "\nTimestep: " << timestep << "\n";
-
-    // Optional: Wheeler-Stretching nur auf curr
-    std::vector<WavefieldEntry> stretched_curr = curr;
-    if (use_wheeler) {
-        apply_wheeler_stretching(stretched_curr, z_max);
-    }
+GridFrame StreamingPipeline::compute_timestep(int timestep, const AccelerationFrames& frames) {
+    GridFrame frame = compute_frame(timestep, frames, raw_index);
+    return finish_timestep(timestep, frame);
+}
 
-    // Interpolation: prev, curr, next separat interpolieren
-    Wavefield interp_prev, interp_curr, interp_next;
+GridFrame StreamingPipeline::compute_frame(int timestep, const AccelerationFrames& frames, SpatialIndex& index) const {
+    TRACE_SPAN("compute frame", timestep);
+    const Wavefield& curr = *frames.curr;
+    GridFrame frame;
+    frame.grid = &grid;
 
-    if (is2D) {
-        auto vx_p = interpolate_to_grid_2d(prev, target_grid, "vx", 4);
-        auto vz_p = interpolate_to_grid_2d(prev, target_grid, "vz", 4);
-        auto p_p  = interpolate_to_grid_2d(prev, target_grid, "pressure", 4);
-
-        auto vx_c = interpolate_to_grid_2d(stretched_curr, target_grid, "vx", 4);
-        auto vz_c = interpolate_to_grid_2d(stretched_curr, target_grid, "vz", 4);
-        auto p_c  = interpolate_to_grid_2d(stretched_curr, target_grid, "pressure", 4);
-
-        auto vx_n = interpolate_to_grid_2d(next, target_grid, "vx", 4);
-        auto vz_n = interpolate_to_grid_2d(next, target_grid, "vz", 4);
-        auto p_n  = interpolate_to_grid_2d(next, target_grid, "pressure", 4);
-
-        for (size_t i = 0; i < target_grid.size(); ++i) {
-            const auto& pt = target_grid[i];
-            interp_prev.push_back({pt[0], pt[1], pt[2], vx_p[i], 0.0, vz_p[i], p_p[i], NAN, NAN, NAN, NAN});
-            interp_curr.push_back({pt[0], pt[1], pt[2], vx_c[i], 0.0, vz_c[i], p_c[i], NAN, NAN, NAN, NAN});
-            interp_next.push_back({pt[0], pt[1], pt[2], vx_n[i], 0.0, vz_n[i], p_n[i], NAN, NAN, NAN, NAN});
-        }
+    if (stencil_shares_layout(frames, acceleration_order)) {
+        // Static grid: one pass over curr's neighbours for all fields and the
+        // acceleration; the stencil frames enter as raw differences. Tree and
+        // neighbour lists are reused while the raw coordinates do not move.
+        TRACE_SPAN("interpolate with acceleration", timestep);
+        const NeighbourList& neighbours = index.query(curr, target_grid);
+        interpolate_fields_with_acceleration(frames, neighbours, interpolated_fields(), wave_dt,
+                                             acceleration_order, frame);
     } else {
-        auto vx_p = interpolate_to_grid(prev, target_grid, "vx", 4);
-        auto vy_p = interpolate_to_grid(prev, target_grid, "vy", 4);
-        auto vz_p = interpolate_to_grid(prev, target_grid, "vz", 4);
-        auto p_p  = interpolate_to_grid(prev, target_grid, "pressure", 4);
-
-        auto vx_c = interpolate_to_grid(stretched_curr, target_grid, "vx", 4);
-        auto vy_c = interpolate_to_grid(stretched_curr, target_grid, "vy", 4);
-        auto vz_c = interpolate_to_grid(stretched_curr, target_grid, "vz", 4);
-        auto p_c  = interpolate_to_grid(stretched_curr, target_grid, "pressure", 4);
-
-        auto vx_n = interpolate_to_grid(next, target_grid, "vx", 4);
-        auto vy_n = interpolate_to_grid(next, target_grid, "vy", 4);
-        auto vz_n = interpolate_to_grid(next, target_grid, "vz", 4);
-        auto p_n  = interpolate_to_grid(next, target_grid, "pressure", 4);
-
-        for (size_t i = 0; i < target_grid.size(); ++i) {
-            const auto& pt = target_grid[i];
-            interp_prev.push_back({pt[0], pt[1], pt[2], vx_p[i], vy_p[i], vz_p[i], p_p[i], NAN, NAN, NAN, NAN});
-            interp_curr.push_back({pt[0], pt[1], pt[2], vx_c[i], vy_c[i], vz_c[i], p_c[i], NAN, NAN, NAN, NAN});
-            interp_next.push_back({pt[0], pt[1], pt[2], vx_n[i], vy_n[i], vz_n[i], p_n[i], NAN, NAN, NAN, NAN});
-        }
+        interpolate_at_targets(timestep, frames, index, frame);
     }
+    if (is2D) frame.vy.assign(grid.size(), 0.0);
+
+    // Optional: Wheeler stretching, sampled at the inverse-mapped target points
+    if (use_wheeler) apply_wheeler(curr, index, frame);
 
     // Elevation only on curr (unstretched)
-    if (is2D) {
-        if (elevation_mode == "z") {
-            compute_surface_elevation_geo_2d_single_timestep(interp_curr, curr);
-        } else {
-            compute_surface_elevation_from_elev_2d_single_timestep(interp_curr, curr);
-        }
-        computeAcceleration2D_from_context(interp_prev, interp_curr, interp_next, wave_dt);
-    } else {
-        if (elevation_mode == "z") {
-            compute_surface_elevation_geo_single_timestep(interp_curr, curr);
-        } else {
-            compute_surface_elevation_from_elev_single_timestep(interp_curr, curr);
-        }
-        computeAcceleration_from_context(interp_prev, interp_curr, interp_next, wave_dt);
+    TRACE_SPAN("elevation", timestep);
+    surface_elevation.compute(frame, curr);
+
+    return frame;
+}
+
+unsigned StreamingPipeline::interpolated_fields() const {
+    return is2D ? (FIELD_VX | FIELD_VZ | FIELD_PRESSURE) : (FIELD_VX | FIELD_VY | FIELD_VZ | FIELD_PRESSURE);
+}
+
+// Frame i of the stencil is frame timestep + i of the stream; a frame passed
+// twice (curr as prev at t = 0) is the same interpolated frame
+void StreamingPipeline::interpolate_at_targets(int timestep,
+                                               const AccelerationFrames& frames,
+                                               SpatialIndex& index,
+                                               GridFrame& frame) const {
+    auto interpolated = [&](const Wavefield* raw, int frame_index) -> std::shared_future<GridFrame> {
+        if (!raw || raw->empty()) return {};
+        return target_frames.get(frame_index, [&, raw, frame_index]() {
+            TRACE_SPAN("interpolate frame", frame_index);
+            GridFrame result;
+            interpolate_fields(*raw, index.query(*raw, target_grid), interpolated_fields(), result);
+            return result;
+        });
+    };
+
+    const int prev_index = (frames.prev == frames.curr) ? timestep : timestep - 1;
+    const int prev2_index = (frames.prev2 == frames.prev) ? prev_index : prev_index - 1;
+    const int next2_index = (frames.next2 == frames.next) ? timestep + 1 : timestep + 2;
+    const std::shared_future<GridFrame> f[5] = {
+        interpolated(frames.prev2, prev2_index), interpolated(frames.prev, prev_index),
+        interpolated(frames.curr, timestep),
+        interpolated(frames.next, timestep + 1), interpolated(frames.next2, next2_index)};
+
+    // The futures of aliased frames share their state, so aliasing carries over
+    auto pointer = [](const std::shared_future<GridFrame>& future) -> const GridFrame* {
+        return future.valid() ? &future.get() : nullptr;
+    };
+    StencilFrames<GridFrame> stencil;
+    stencil.prev2 = pointer(f[0]);
+    stencil.prev = pointer(f[1]);
+    stencil.curr = pointer(f[2]);
+    stencil.next = pointer(f[3]);
+    stencil.next2 = pointer(f[4]);
+
+    const GridFrame& curr = *stencil.curr;
+    frame.vx = curr.vx;
+    frame.vy = curr.vy;
+    frame.vz = curr.vz;
+    frame.pressure = curr.pressure;
+
+    TRACE_SPAN("acceleration", timestep);
+    computeAcceleration_from_frames(stencil, wave_dt, acceleration_order, frame);
+}
+
+void StreamingPipeline::apply_wheeler(const std::vector<WavefieldEntry>& curr,
+                                      SpatialIndex& index,
+                                      GridFrame& frame) const {
+    TRACE_SPAN("wheeler");
+    std::vector<Value> eta;
+    wheeler_surface.evaluate(grid, curr, eta);
+
+    std::vector<size_t> moved;
+    std::vector<std::array<double, 3>> queries;
+    wheeler_inverse_targets(target_grid, eta, z_max, moved, queries);
+    if (moved.empty()) return;
+
+    // Only the moved targets are searched and interpolated again
+    NeighbourList neighbours;
+    index.search(curr, queries, neighbours);
+
+    GridFrame sampled;
+    if (is2D) interpolate_fields(curr, neighbours, FIELD_VX | FIELD_VZ | FIELD_PRESSURE, sampled);
+    else      interpolate_fields(curr, neighbours, FIELD_VX | FIELD_VY | FIELD_VZ | FIELD_PRESSURE, sampled);
+
+    for (size_t j = 0; j < moved.size(); ++j) {
+        const size_t i = moved[j];
+        frame.vx[i] = sampled.vx[j];
+        if (!is2D) frame.vy[i] = sampled.vy[j];
+        frame.vz[i] = sampled.vz[j];
+        frame.pressure[i] = sampled.pressure[j];
     }
+}
+
+GridFrame StreamingPipeline::finish_timestep(int timestep, GridFrame& frame) {
+    TRACE_SPAN("diagnostics", timestep);
+    std::cout << "\nTimestep: " << timestep << "\n";
 
     // Diagnostics
-    if (is2D) report_diagnostics_2d(interp_curr, timestep);
-    else      report_diagnostics_3d(interp_curr, timestep);
+    if (is2D) report_diagnostics_2d(frame, timestep);
+    else      report_diagnostics_3d(frame, timestep);
+
+    // 2D frames are broadcast along y by the export (see seastate_layout)
+    return std::move(frame);
+}
 
-    // Inflate 2D
-    if (is2D) inflate_wavefield_y(interp_curr, y_total, ny_usr);
+void StreamingPipeline::write_timestep(int timestep, GridFrame export_frame) {
+    TRACE_SPAN("write timestep", timestep);
+    auto frame = std::make_shared<const GridFrame>(std::move(export_frame));
 
     // Export
-    bool append_wavefiles = (timestep > 0);
-    generate_all_wavefiles(interp_curr, wave_dt, timestep, append_wavefiles);
+    if (positional) {
+        // Block offsets follow the export order; formatting and writing run on the pool
+        const SeaStateLayout* layout = &seastate_layout;
+        const bool wavefiles = positional_wavefiles;
+        const bool elevation = positional_elevation;
+        positional->submit(blocks_submitted++, [=](char* const* blocks) {
+            TRACE_SPAN("format blocks", timestep);
+            if (wavefiles) format_wavefile_blocks(*layout, *frame, timestep, blocks);
+            if (elevation) format_elevation_block(*layout, *frame, timestep, blocks[wavefiles ? NUM_WAVE_COMPONENTS : 0]);
+        });
+    } else {
+        bool append_wavefiles = (timestep > 0);
+        {
+            TRACE_SPAN("export wavefiles", timestep);
+            generate_all_wavefiles(output, seastate_layout, *frame, output_dir, timestep, append_wavefiles);
+        }
 
-    bool append_elev = first_elevation_written;
-    write_surface_elevation(interp_curr, "REEF2FAST.Elev", wave_dt, timestep, append_elev);
-    first_elevation_written = true;
+        bool append_elev = first_elevation_written;
+        {
+            TRACE_SPAN("export elevation", timestep);
+            write_surface_elevation(output, seastate_layout, *frame, output_dir + "/REEF2FAST.Elev", timestep, append_elev);
+        }
+        first_elevation_written = true;
+    }
 
     if (write_csv) {
+        TRACE_SPAN("export CSV", timestep);
         bool append = (timestep > 0);
-        write_out_csv(interp_curr, "../output/interpolated_wavefield.csv", timestep, append);
+        write_out_csv(output, *frame, output_dir + "/interpolated_wavefield.csv", timestep, append, y_slices);
+    }
+
+    // Large buffers go to the flush thread; small ones keep collecting
+    output.commit();
+}
+
+void StreamingPipeline::open_positional_output() {
+    positional = std::make_unique<PositionalWriter>(export_threads, 2 * static_cast<size_t>(export_threads));
+    const SeaStateLayout& layout = seastate_layout;
+
+    // Files the serial appender would leave without a header are not written
+    if (!layout.kinematics_valid) {
+        std::cerr << "Insufficient spatial resolution in grid.\n";
+    } else {
+        const size_t block_bytes = wavefile_block_bytes(layout);
+        for (const WaveComponent& c : WAVE_COMPONENTS) {
+            if (!positional->add_file(output_dir + "/" + c.filename, wavefile_header(layout, c), block_bytes)) {
+                std::cerr << "Error: Could not open " << c.filename << " for writing.\n";
+            }
+        }
+        positional_wavefiles = true;
     }
-}
\ No newline at end of file
+
+    const std::string elev_path = output_dir + "/REEF2FAST.Elev";
+    if (layout.surface_order.empty()) {
+        std::cerr << "[Warning] No surface points (z ≈ 0.0) found in the grid\n";
+    } else if (!layout.elevation_valid) {
+        std::cerr << "[Error] Not enough surface points for grid metadata.\n";
+    } else {
+        if (!positional->add_file(elev_path, layout.elevation_header, elevation_block_bytes(layout))) {
+            std::cerr << "[Error] Could not open " << elev_path << " for writing.\n";
+        }
+        positional_elevation = true;
+    }
+
+    // Timesteps 0 .. wave_tmax / wave_dt, as far as the control file tells
+    if (wave_dt > 0.0 && wave_tmax > 0.0) {
+        positional->reserve(static_cast<size_t>(wave_tmax / wave_dt + 0.5) + 1);
+    }
+}
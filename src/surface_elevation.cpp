@@ -0,0 +1,208 @@
+#include "surface_elevation.hpp"
+#include "common.hpp"
+#include "idw_kernel.hpp"
+#include "trace.hpp"
+#include "../external/nanoflann.hpp"
+#include <array>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr int NEIGHBOURS = 4;
+
+// Column key of a raw point and its position in the column tree:
+// rounded (x, y), or rounded x in a 2D case
+template <int DIM> struct ColumnKey;
+
+template <> struct ColumnKey<2> {
+    using type = std::pair<double, double>;
+    static type of(const WavefieldEntry& e) { return {round_to(e.x), round_to(e.y)}; }
+    static std::array<double, 2> coords(const type& key) { return {key.first, key.second}; }
+    static std::array<double, 2> query(const GridGeometry& grid, size_t i) { return {grid.x[i], grid.y[i]}; }
+};
+
+template <> struct ColumnKey<1> {
+    using type = double;
+    static type of(const WavefieldEntry& e) { return round_to(e.x); }
+    static std::array<double, 1> coords(const type& key) { return {key}; }
+    static std::array<double, 1> query(const GridGeometry& grid, size_t i) { return {grid.x[i]}; }
+};
+
+template <int DIM>
+struct ColumnCloud {
+    std::vector<std::array<double, DIM>> pts;
+
+    inline size_t kdtree_get_point_count() const { return pts.size(); }
+    inline double kdtree_get_pt(const size_t idx, const size_t dim) const { return pts[idx][dim]; }
+    template <class BBOX> bool kdtree_get_bbox(BBOX&) const { return false; }
+};
+
+template <int DIM>
+using ColumnTree = nanoflann::KDTreeSingleIndexAdaptor<
+    nanoflann::L2_Simple_Adaptor<double, ColumnCloud<DIM>>,
+    ColumnCloud<DIM>,
+    DIM
+>;
+
+// Surface value of a raw point
+inline double surface_value(const WavefieldEntry& e, SurfaceElevation::Source source) {
+    return (source == SurfaceElevation::Source::GEOMETRIC) ? e.z : static_cast<double>(e.elevation);
+}
+
+} // namespace
+
+struct SurfaceElevation::Plan {
+    const GridGeometry* grid = nullptr;
+    size_t grid_size = 0;
+
+    // Raw coordinates the plan was built from
+    std::vector<double> raw_x, raw_y;
+
+    // Raw points of column c: members[column_begin[c] .. column_begin[c + 1]), in raw order
+    std::vector<size_t> column_begin;
+    std::vector<size_t> members;
+
+    // Neighbour columns of every unique target column, and the target column of every grid point
+    NeighbourList neighbours;
+    std::vector<size_t> target_column;
+
+    bool matches(const Wavefield& raw, const GridGeometry& g) const {
+        if (&g != grid || g.size() != grid_size || raw.size() != raw_x.size()) return false;
+        for (size_t i = 0; i < raw.size(); ++i) {
+            if (raw[i].x != raw_x[i] || raw[i].y != raw_y[i]) return false;
+        }
+        return true;
+    }
+
+    size_t num_columns() const { return column_begin.size() - 1; }
+
+    // Groups the raw points in the iteration order of Map. The column order
+    // decides which of several equidistant columns the kNN search returns, so
+    // every mode keeps the container it has always grouped with.
+    template <int DIM, typename Map>
+    void build(const Wavefield& raw, const GridGeometry& g) {
+        grid = &g;
+        grid_size = g.size();
+        raw_x.resize(raw.size());
+        raw_y.resize(raw.size());
+        for (size_t i = 0; i < raw.size(); ++i) {
+            raw_x[i] = raw[i].x;
+            raw_y[i] = raw[i].y;
+        }
+
+        Map columns;
+        for (size_t i = 0; i < raw.size(); ++i) columns[ColumnKey<DIM>::of(raw[i])].push_back(i);
+
+        ColumnCloud<DIM> cloud;
+        cloud.pts.reserve(columns.size());
+        members.reserve(raw.size());
+        for (const auto& [key, ids] : columns) {
+            cloud.pts.push_back(ColumnKey<DIM>::coords(key));
+            column_begin.push_back(members.size());
+            members.insert(members.end(), ids.begin(), ids.end());
+        }
+        column_begin.push_back(members.size());
+
+        // Unique target columns; every grid point shares the neighbours of its column
+        std::map<std::array<double, DIM>, size_t> target_ids;
+        std::vector<std::array<double, DIM>> queries;
+        target_column.resize(g.size());
+        for (size_t i = 0; i < g.size(); ++i) {
+            auto query = ColumnKey<DIM>::query(g, i);
+            auto [it, inserted] = target_ids.emplace(query, queries.size());
+            if (inserted) queries.push_back(query);
+            target_column[i] = it->second;
+        }
+
+        ColumnTree<DIM> tree(DIM, cloud, nanoflann::KDTreeSingleIndexAdaptorParams(10));
+        tree.buildIndex();
+
+        neighbours.k = NEIGHBOURS;
+        neighbours.indices.resize(queries.size() * NEIGHBOURS);
+        neighbours.dists.resize(queries.size() * NEIGHBOURS);
+        neighbours.count.resize(queries.size());
+        for (size_t t = 0; t < queries.size(); ++t) {
+            nanoflann::KNNResultSet<double> resultSet(NEIGHBOURS);
+            resultSet.init(&neighbours.indices[t * NEIGHBOURS], &neighbours.dists[t * NEIGHBOURS]);
+            tree.findNeighbors(resultSet, queries[t].data(), nanoflann::SearchParameters(10));
+            neighbours.count[t] = static_cast<int>(resultSet.size());
+        }
+    }
+};
+
+SurfaceElevation::SurfaceElevation(int dims, Source source)
+    : dims(dims), source(source), plans_built(0) {}
+
+SurfaceElevation::~SurfaceElevation() = default;
+
+size_t SurfaceElevation::num_plans() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return plans_built;
+}
+
+std::shared_ptr<const SurfaceElevation::Plan> SurfaceElevation::plan_for(const Wavefield& raw,
+                                                                         const GridGeometry& grid) const {
+    std::shared_ptr<const Plan> current;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = plan;
+    }
+    if (current && current->matches(raw, grid)) return current;
+
+    TRACE_SPAN("elevation plan");
+    auto fresh = std::make_shared<Plan>();
+    if (dims == 2) {
+        fresh->build<2, std::map<ColumnKey<2>::type, std::vector<size_t>>>(raw, grid);
+    } else if (source == Source::GEOMETRIC) {
+        fresh->build<1, std::map<ColumnKey<1>::type, std::vector<size_t>>>(raw, grid);
+    } else {
+        fresh->build<1, std::unordered_map<ColumnKey<1>::type, std::vector<size_t>>>(raw, grid);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    plan = fresh;
+    ++plans_built;
+    return fresh;
+}
+
+void SurfaceElevation::compute(GridFrame& target, const Wavefield& raw) const {
+    evaluate(*target.grid, raw, target.elevation);
+}
+
+void SurfaceElevation::evaluate(const GridGeometry& grid, const Wavefield& raw, std::vector<Value>& out_values) const {
+    std::shared_ptr<const Plan> p = plan_for(raw, grid);
+
+    // Column maxima, one column per iteration (first maximum wins, as std::max_element)
+    const size_t num_columns = p->num_columns();
+    std::vector<Value> column_surface(num_columns);
+    #pragma omp parallel
+    {
+        TRACE_SPAN("column maxima");   // per thread
+
+        #pragma omp for schedule(static) nowait
+        for (std::ptrdiff_t c = 0; c < static_cast<std::ptrdiff_t>(num_columns); ++c) {
+            const size_t* first = p->members.data() + p->column_begin[c];
+            const size_t* last = p->members.data() + p->column_begin[c + 1];
+            double best = surface_value(raw[*first], source);
+            for (const size_t* m = first + 1; m != last; ++m) {
+                double v = surface_value(raw[*m], source);
+                if (best < v) best = v;
+            }
+            column_surface[c] = static_cast<Value>(best);
+        }
+    }
+
+    // One IDW evaluation per target column, broadcast down the vertical
+    std::vector<Value> target_surface(p->neighbours.num_targets());
+    const Value* column = column_surface.data();
+    Value* out = target_surface.data();
+    idw::interpolate(p->neighbours, &column, 1, &out);
+
+    out_values.resize(grid.size());
+    for (size_t i = 0; i < grid.size(); ++i) {
+        out_values[i] = target_surface[p->target_column[i]];
+    }
+}
\ No newline at end of file
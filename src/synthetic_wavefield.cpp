@@ -0,0 +1,198 @@
+#include "synthetic_wavefield.hpp"
+#include "common.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr double GRAVITY = 9.81;
+constexpr double RHO_WATER = 1025.0;
+
+// Wave number of ω² = g k tanh(k h) by Newton iteration from the deep-water value
+double solve_dispersion(double omega, double depth) {
+    double k = omega * omega / GRAVITY;
+    for (int i = 0; i < 50; ++i) {
+        const double t = std::tanh(k * depth);
+        const double f = GRAVITY * k * t - omega * omega;
+        const double df = GRAVITY * (t + k * depth * (1.0 - t * t));
+        const double step = f / df;
+        k -= step;
+        if (std::abs(step) < 1e-14 * k) break;
+    }
+    return k;
+}
+
+// Appends one CSV value ("%.*g")
+void append_number(std::string& out, double value, int digits) {
+    char buf[32];
+    const int n = std::snprintf(buf, sizeof(buf), "%.*g", digits, value);
+    out.append(buf, static_cast<size_t>(n));
+}
+
+struct FileCloser {
+    void operator()(std::FILE* f) const { std::fclose(f); }
+};
+
+} // namespace
+
+const char* wave_theory_name(WaveTheory theory) {
+    return (theory == WaveTheory::STOKES2) ? "stokes2" : "airy";
+}
+
+WaveTheory parse_wave_theory(const std::string& name) {
+    if (name == "airy") return WaveTheory::AIRY;
+    if (name == "stokes2") return WaveTheory::STOKES2;
+    throw std::invalid_argument("unknown wave theory: " + name + " (airy or stokes2)");
+}
+
+SyntheticWave::SyntheticWave(double height, double period, double depth, double direction,
+                             WaveTheory theory)
+    : amplitude(0.5 * height),
+      omega(2.0 * M_PI / period),
+      depth(depth),
+      k(solve_dispersion(2.0 * M_PI / period, depth)),
+      cos_dir(std::cos(direction)),
+      sin_dir(std::sin(direction)),
+      theory(theory) {
+    const double s = std::sinh(k * depth);
+    harmonic[0] = amplitude * omega / s;
+    harmonic[1] = 0.0;
+    second_elevation = 0.0;
+    if (theory == WaveTheory::STOKES2) {
+        const double a2 = amplitude * amplitude;
+        harmonic[1] = 0.75 * omega * k * a2 / (s * s * s * s);
+        second_elevation = 0.25 * k * a2 * std::cosh(k * depth) * (2.0 + std::cosh(2.0 * k * depth)) / (s * s * s);
+    }
+}
+
+double SyntheticWave::phase(double x, double y, double t) const {
+    return k * (x * cos_dir + y * sin_dir) - omega * t;
+}
+
+double SyntheticWave::elevation(double x, double y, double t) const {
+    const double theta = phase(x, y, t);
+    return amplitude * std::cos(theta) + second_elevation * std::cos(2.0 * theta);
+}
+
+void SyntheticWave::kinematics(double x, double y, double z, double t,
+                               double& u, double& v, double& w, double& pressure) const {
+    const double theta = phase(x, y, t);
+    const double kz = k * (z + depth);
+
+    double horizontal = 0.0;
+    w = 0.0;
+    for (int n = 1; n <= 2; ++n) {
+        horizontal += harmonic[n - 1] * std::cosh(n * kz) * std::cos(n * theta);
+        w += harmonic[n - 1] * std::sinh(n * kz) * std::sin(n * theta);
+    }
+    u = horizontal * cos_dir;
+    v = horizontal * sin_dir;
+
+    pressure = RHO_WATER * GRAVITY * amplitude * std::cosh(kz) / std::cosh(k * depth) * std::cos(theta);
+    if (theory == WaveTheory::STOKES2) {
+        const double s = std::sinh(k * depth);
+        const double c = RHO_WATER * GRAVITY * k * amplitude * amplitude / std::sinh(2.0 * k * depth);
+        pressure += 1.5 * c * (std::cosh(2.0 * kz) / (s * s) - 1.0 / 3.0) * std::cos(2.0 * theta)
+                  - 0.5 * c * (std::cosh(2.0 * kz) - 1.0);
+    }
+}
+
+void SyntheticWave::acceleration(double x, double y, double z, double t,
+                                 double& ax, double& ay, double& az) const {
+    const double theta = phase(x, y, t);
+    const double kz = k * (z + depth);
+
+    double horizontal = 0.0;
+    az = 0.0;
+    for (int n = 1; n <= 2; ++n) {
+        horizontal += harmonic[n - 1] * n * omega * std::cosh(n * kz) * std::sin(n * theta);
+        az -= harmonic[n - 1] * n * omega * std::sinh(n * kz) * std::cos(n * theta);
+    }
+    ax = horizontal * cos_dir;
+    ay = horizontal * sin_dir;
+}
+
+SyntheticGrid synthetic_grid_from_control(const std::string& control_file, double refine) {
+    SyntheticGrid grid;
+    int NX, NY, NZ;
+    if (!read_control_file(control_file, grid.x_min, grid.x_max, grid.y_min, grid.y_max,
+                           grid.z_min, grid.z_max, NX, NY, NZ)) {
+        throw std::runtime_error("Failed to read " + control_file);
+    }
+
+    grid.is2D = (NY == 1);
+    grid.nx = std::max(2, static_cast<int>(std::lround(refine * NX)) + 1);
+    grid.ny = grid.is2D ? 2 : std::max(2, static_cast<int>(std::lround(refine * NY)) + 1);
+    grid.nz = std::max(2, static_cast<int>(std::lround(refine * NZ)) + 1);
+    return grid;
+}
+
+// Frames are formatted column by column in parallel and written in order;
+// rows of a frame run over x, then y, then the sigma levels of a column
+size_t write_synthetic_wavefield(const std::string& path,
+                                 const SyntheticWave& wave,
+                                 const SyntheticGrid& grid,
+                                 int num_timesteps,
+                                 double dt) {
+    std::unique_ptr<std::FILE, FileCloser> file(std::fopen(path.c_str(), "wb"));
+    if (!file) throw std::runtime_error("Could not open " + path + " for writing");
+
+    const std::string header = "TimeStep,velocity:0,velocity:1,velocity:2,pressure,elevation,Points:0,Points:1,Points:2\n";
+    bool ok = std::fwrite(header.data(), 1, header.size(), file.get()) == header.size();
+
+    const double depth = grid.z_max - grid.z_min;
+    std::vector<double> ys(grid.ny);
+    for (int j = 0; j < grid.ny; ++j) {
+        // 2D: the two node rows inside NHFLOW's single cell
+        ys[j] = grid.is2D ? grid.y_min + (grid.y_max - grid.y_min) * (0.25 + 0.5 * j)
+                          : grid.y_min + (grid.y_max - grid.y_min) * j / (grid.ny - 1);
+    }
+
+    std::vector<std::string> columns(grid.nx);
+    for (int step = 0; step < num_timesteps && ok; ++step) {
+        const double t = step * dt;
+
+        #pragma omp parallel for schedule(dynamic, 8)
+        for (int i = 0; i < grid.nx; ++i) {
+            std::string& out = columns[i];
+            out.clear();
+            const double x = grid.x_min + (grid.x_max - grid.x_min) * i / (grid.nx - 1);
+            for (int j = 0; j < grid.ny; ++j) {
+                const double eta = wave.elevation(x, ys[j], t);
+                for (int l = 0; l < grid.nz; ++l) {
+                    // Sigma level: bed (l = 0) to free surface, relative to SWL
+                    const double z = -depth + (depth + eta) * l / (grid.nz - 1);
+                    double u, v, w, p;
+                    wave.kinematics(x, ys[j], z, t, u, v, w, p);
+                    if (grid.is2D) v = 0.0;
+
+                    append_number(out, step, 10);
+                    for (double value : {u, v, w, p, grid.z_max + eta}) {
+                        out += ',';
+                        append_number(out, value, 6);
+                    }
+                    for (double coord : {x, ys[j], grid.z_max + z}) {
+                        out += ',';
+                        append_number(out, coord, 9);
+                    }
+                    out += '\n';
+                }
+            }
+        }
+
+        for (const std::string& text : columns) {
+            if (std::fwrite(text.data(), 1, text.size(), file.get()) != text.size()) {
+                ok = false;
+                break;
+            }
+        }
+    }
+
+    if (!ok || std::fflush(file.get()) != 0) throw std::runtime_error("Could not write " + path);
+    return static_cast<size_t>(num_timesteps) * grid.points();
+}
\ No newline at end of file
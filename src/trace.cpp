@@ -0,0 +1,147 @@
+#include "trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct Span {
+    const char* name;
+    int timestep;
+    int64_t start_ns;
+    int64_t dur_ns;
+};
+
+// Spans of one thread. Buffers live as long as the process, so a span that
+// ends after trace_stop() or a thread that exits never touches freed memory.
+struct ThreadTrace {
+    int tid = 0;
+    std::mutex mutex;          // uncontended except while a recording is written
+    std::string name;
+    std::vector<Span> spans;
+};
+
+using Clock = std::chrono::steady_clock;
+
+std::atomic<bool> recording(false);
+std::mutex registry_mutex;
+std::vector<std::unique_ptr<ThreadTrace>> registry;
+std::atomic<int64_t> origin_ns(0);   // start of the recording
+
+int64_t clock_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+int64_t now_ns() {
+    return clock_ns() - origin_ns.load(std::memory_order_relaxed);
+}
+
+ThreadTrace& this_thread_trace() {
+    thread_local ThreadTrace* trace = nullptr;
+    if (!trace) {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        registry.push_back(std::make_unique<ThreadTrace>());
+        trace = registry.back().get();
+        trace->tid = static_cast<int>(registry.size());
+    }
+    return *trace;
+}
+
+void write_json_string(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') out << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20) out << ' ';
+        else out << c;
+    }
+    out << '"';
+}
+
+// Microseconds with nanosecond digits, as the trace-event format expects
+void write_us(std::ostream& out, int64_t ns) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%lld.%03lld",
+                  static_cast<long long>(ns / 1000), static_cast<long long>(ns % 1000));
+    out << buf;
+}
+
+} // namespace
+
+void trace_start() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (auto& trace : registry) {
+        std::lock_guard<std::mutex> spans_lock(trace->mutex);
+        trace->spans.clear();
+    }
+    origin_ns.store(clock_ns(), std::memory_order_relaxed);
+    recording.store(true, std::memory_order_release);
+}
+
+bool trace_stop(const std::string& path) {
+    recording.store(false, std::memory_order_release);
+
+    std::ofstream out(path);
+    if (!out) return false;
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&]() {
+        if (!first) out << ",\n";
+        first = false;
+    };
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (auto& trace : registry) {
+        std::lock_guard<std::mutex> spans_lock(trace->mutex);
+        if (trace->spans.empty()) continue;
+
+        separator();
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << trace->tid << ",\"args\":{\"name\":";
+        write_json_string(out, trace->name.empty() ? "thread " + std::to_string(trace->tid) : trace->name);
+        out << "}}";
+
+        // Spans are recorded when they end; viewers nest them by start time
+        std::stable_sort(trace->spans.begin(), trace->spans.end(),
+                         [](const Span& a, const Span& b) { return a.start_ns < b.start_ns; });
+        for (const Span& s : trace->spans) {
+            separator();
+            out << "{\"name\":";
+            write_json_string(out, s.name);
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << trace->tid << ",\"ts\":";
+            write_us(out, s.start_ns);
+            out << ",\"dur\":";
+            write_us(out, s.dur_ns);
+            if (s.timestep >= 0) out << ",\"args\":{\"timestep\":" << s.timestep << "}";
+            out << "}";
+        }
+        trace->spans.clear();
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+void trace_set_thread_name(const std::string& name) {
+    ThreadTrace& trace = this_thread_trace();
+    std::lock_guard<std::mutex> lock(trace.mutex);
+    trace.name = name;
+}
+
+TraceSpan::TraceSpan(const char* name, int timestep)
+    : name(name),
+      timestep(timestep),
+      start_ns(recording.load(std::memory_order_acquire) ? now_ns() : -1) {}
+
+TraceSpan::~TraceSpan() {
+    if (start_ns < 0 || !recording.load(std::memory_order_acquire)) return;
+    const int64_t end_ns = now_ns();
+
+    ThreadTrace& trace = this_thread_trace();
+    std::lock_guard<std::mutex> lock(trace.mutex);
+    trace.spans.push_back({name, timestep, start_ns, end_ns - start_ns});
+}
\ No newline at end of file
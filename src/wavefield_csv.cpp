@@ -0,0 +1,106 @@
+#include "wavefield_csv.hpp"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+enum Column { COL_T = 0, COL_U, COL_V, COL_W, COL_P, COL_ETA, COL_X, COL_Y, COL_Z };
+
+// Skips blanks and quotes that some exporters put around values
+inline const char* skip_blanks(const char* b, const char* e) {
+    while (b < e && (*b == ' ' || *b == '\t' || *b == '"' || *b == '+')) ++b;
+    return b;
+}
+
+template <typename T>
+inline bool parse_number(const char* b, const char* e, T& value) {
+    b = skip_blanks(b, e);
+    auto res = std::from_chars(b, e, value);
+    return res.ec == std::errc();
+}
+
+} // namespace
+
+WavefieldCsvReader::WavefieldCsvReader(const char* begin, const char* end)
+    : cursor(begin), end(end), field_start{}, num_rows(0), num_skipped(0) {}
+
+bool WavefieldCsvReader::next() {
+    while (cursor < end) {
+        const char* line = cursor;
+        const char* nl = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        const char* line_end = nl ? nl : end;
+        cursor = nl ? nl + 1 : end;
+
+        // Locate the column boundaries
+        int col = 0;
+        field_start[col++] = line;
+        const char* p = line;
+        while (col < NUM_COLUMNS) {
+            const char* comma = static_cast<const char*>(std::memchr(p, ',', line_end - p));
+            if (!comma) break;
+            field_start[col++] = comma + 1;
+            p = comma + 1;
+        }
+        field_start[NUM_COLUMNS] = line_end;
+
+        if (col == NUM_COLUMNS) {
+            ++num_rows;
+            return true;
+        }
+
+        // Empty or truncated line
+        if (line_end > line && !(line_end - line == 1 && *line == '\r')) ++num_skipped;
+    }
+    return false;
+}
+
+double WavefieldCsvReader::y() const {
+    double y;
+    return parse_number(field_start[COL_Y], field_start[COL_Y + 1], y) ? y : NAN;
+}
+
+bool WavefieldCsvReader::parse(int& timestep, CachedRow& row) const {
+    const char* const* f = field_start;
+    return parse_number(f[COL_T],   f[COL_T + 1],   timestep)
+        && parse_number(f[COL_U],   f[COL_U + 1],   row.vx)
+        && parse_number(f[COL_V],   f[COL_V + 1],   row.vy)
+        && parse_number(f[COL_W],   f[COL_W + 1],   row.vz)
+        && parse_number(f[COL_P],   f[COL_P + 1],   row.pressure)
+        && parse_number(f[COL_ETA], f[COL_ETA + 1], row.elevation)
+        && parse_number(f[COL_X],   f[COL_X + 1],   row.x)
+        && parse_number(f[COL_Y],   f[COL_Y + 1],   row.y)
+        && parse_number(f[COL_Z],   f[COL_Z + 1],   row.z);
+}
+
+const char* skip_csv_header(const char* begin, const char* end) {
+    const char* nl = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+    return nl ? nl + 1 : end;
+}
+
+const char* align_to_row_start(const char* begin, const char* p) {
+    while (p > begin && p[-1] != '\n') --p;
+    return p;
+}
+
+const char* align_to_next_row(const char* p, const char* end) {
+    if (p >= end) return end;
+    if (p[-1] == '\n') return p;
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return nl ? nl + 1 : end;
+}
+
+const char* last_timestep_boundary(const char* begin, const char* end) {
+    // Walk rows backwards from the end until the timestep changes
+    const char* row = align_to_row_start(begin, end > begin ? end - 1 : begin);
+    int last_t = 0;
+    if (!parse_number(row, end, last_t)) return nullptr;
+
+    while (row > begin) {
+        const char* prev_row = align_to_row_start(begin, row - 1);
+        int t = 0;
+        if (parse_number(prev_row, row, t) && t != last_t) return row;
+        row = prev_row;
+    }
+    return nullptr;
+}
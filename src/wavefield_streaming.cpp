@@ -1,187 +1,395 @@
 #include "wavefield_streaming.hpp"
+#include "frame_cache.hpp"
+#include "wavefield_csv.hpp"
+#include "mapped_file.hpp"
 #include "common.hpp"
-#include <fstream>
-#include <sstream>
+#include "trace.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <iostream>
-#include <map>
-#include <set>
 #include <cmath>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+
+using FrameCallback = std::function<void(int,
+                                         const std::vector<WavefieldEntry>&,
+                                         const std::vector<WavefieldEntry>&,
+                                         const std::vector<WavefieldEntry>&)>;
+
+// Recycled frame buffers. A frame handed out by acquire() returns its buffer to
+// the pool when its last holder releases it, which may be any pipeline thread,
+// so the free list is locked. Buffers keep their capacity; new ones are
+// reserved to the size of the first frame.
+class FramePool {
+public:
+    FramePool() : state(std::make_shared<State>()), frame_size(0) {}
+
+    void reserve(size_t n) { frame_size = n; }
+
+    std::shared_ptr<Wavefield> acquire() {
+        std::unique_ptr<Wavefield> frame;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (!state->free.empty()) {
+                frame = std::move(state->free.back());
+                state->free.pop_back();
+            }
+        }
+        if (!frame) {
+            frame = std::make_unique<Wavefield>();
+            frame->reserve(frame_size);
+        }
+        frame->clear();  // keeps the capacity
+
+        // The deleter owns the free list, so frames may outlive the pool
+        std::shared_ptr<State> owner = state;
+        return std::shared_ptr<Wavefield>(frame.release(), [owner](Wavefield* f) {
+            std::lock_guard<std::mutex> lock(owner->mutex);
+            owner->free.emplace_back(f);
+        });
+    }
 
-// Stream wavefield CSV in 3D: passes (prev, curr, next) to the callback as they become available
-void stream_wavefield_with_context(
-    const std::string& filename,
-    double z_max,
-    std::function<void(int,
-                       const std::vector<WavefieldEntry>&,
-                       const std::vector<WavefieldEntry>&,
-                       const std::vector<WavefieldEntry>&)> callback)
-{
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        throw std::runtime_error("Could not open wavefield CSV: " + filename);
+private:
+    struct State {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Wavefield>> free;
+    };
+
+    std::shared_ptr<State> state;
+    size_t frame_size;
+};
+
+// Sliding (prev, curr, next) window over the timesteps of the wavefield.
+//
+// The window is a ring of three frames: frame s+1 replaces frame s-2 once
+// timestep s-1 has been processed. Frames come from a FramePool, so a frame the
+// callback keeps stays valid after it has left the window, and steady-state
+// ingest reuses the buffers of released frames instead of touching the heap.
+// A frame is handed to the callback only once it is complete, i.e. when the
+// next timestep starts.
+class TimestepWindow {
+public:
+    explicit TimestepWindow(const SharedFrameCallback& callback)
+        : callback(callback), empty_frame(std::make_shared<const Wavefield>()), num_frames(0), frame_open(false) {}
+
+    void push(int timestep, const WavefieldEntry& entry) {
+        if (!frame_open || timestep != slot_timestep[slot(num_frames - 1)]) {
+            begin_frame(timestep);
+        }
+        slots[slot(num_frames - 1)]->push_back(entry);
     }
 
-    std::string line;
-    std::getline(file, line); // Skip CSV header
+    // Final fallback: process the last remaining timestep without a successor
+    void finish() {
+        if (!frame_open) return;
+        complete_frame();
+        frame_open = false;
 
-    std::map<int, std::vector<WavefieldEntry>> buffer;
-    std::set<int> called_timesteps;
+        size_t last = num_frames - 1;
+        if (last >= 1) {
+            callback(slot_timestep[slot(last)], slots[slot(last - 1)], slots[slot(last)], empty_frame);
+        }
+    }
 
-    while (std::getline(file, line)) {
-        std::stringstream ss(line);
-        int timestep;
-        char comma;
-        WavefieldEntry entry;
+private:
+    static size_t slot(size_t frame) { return frame % 3; }
 
-        ss >> timestep >> comma
-           >> entry.vx >> comma
-           >> entry.vy >> comma
-           >> entry.vz >> comma
-           >> entry.pressure >> comma
-           >> entry.elevation >> comma
-           >> entry.x >> comma
-           >> entry.y >> comma
-           >> entry.z;
-           
-        // Convert from REEF3D vertical system to OpenFAST convention (z=0 at SWL, negative downward)
-        entry.z = round_to(entry.z - z_max);
-        entry.elevation = round_to(entry.elevation - z_max);
+    void begin_frame(int timestep) {
+        if (frame_open) complete_frame();
 
-        buffer[timestep].push_back(entry);
+        size_t s = slot(num_frames);
+        slots[s].reset();  // frame s-2 back to the pool unless a consumer still holds it
+        slots[s] = pool.acquire();
+        slot_timestep[s] = timestep;
+        ++num_frames;
+        frame_open = true;
+    }
 
-        // Process timesteps in order: always t0 first (including t=0)
-        while (buffer.size() >= 3) {
-            auto it = buffer.begin();
-            int t0 = it->first; auto& wf0 = it->second; ++it;
-            int t1 = it->first; auto& wf1 = it->second; ++it;
-            int t2 = it->first; auto& wf2 = it->second;
+    // Called once frame num_frames-1 holds all of its rows
+    void complete_frame() {
+        size_t f = num_frames - 1;
 
-            if (t0 == 0 && called_timesteps.count(0) == 0) {
-                callback(0, wf0, wf0, wf1);  // Special handling for t=0
-                called_timesteps.insert(0);
-            }
+        if (f == 0) {
+            pool.reserve(slots[0]->size());
+            return;
+        }
 
-            if (called_timesteps.count(t1) == 0) {
-                callback(t1, wf0, wf1, wf2);
-                called_timesteps.insert(t1);
-            }
+        // Special handling for t=0: no predecessor, curr doubles as prev
+        if (f == 1 && slot_timestep[slot(0)] == 0) {
+            callback(0, slots[slot(0)], slots[slot(0)], slots[slot(1)]);
+        }
 
-            buffer.erase(t0);  // Slide window
+        if (f >= 2) {
+            callback(slot_timestep[slot(f - 1)], slots[slot(f - 2)], slots[slot(f - 1)], slots[slot(f)]);
         }
     }
 
-    // Final fallback: process the last two remaining timesteps
-    if (buffer.size() >= 2) {
-        auto it = buffer.begin();
-        int t0 = it->first; auto& wf0 = it->second; ++it;
-        int t1 = it->first; auto& wf1 = it->second;
+    const SharedFrameCallback& callback;
+    FramePool pool;
+    std::array<std::shared_ptr<Wavefield>, 3> slots;
+    std::array<int, 3> slot_timestep{};
+    const SharedFrame empty_frame;
+    size_t num_frames;
+    bool frame_open;
+};
+
+// Converts raw REEF3D rows into pipeline entries and feeds them to the window
+class RowIngest {
+public:
+    RowIngest(double z_max, bool is2D, TimestepWindow& window)
+        : z_max(z_max), is2D(is2D), y_ref(NAN), window(window) {}
+
+    void add(int timestep, const CachedRow& row) {
+        WavefieldEntry entry;
+        entry.vx = row.vx;
+        entry.vy = row.vy;
+        entry.vz = row.vz;
+        entry.pressure = row.pressure;
+        entry.x = row.x;
+        entry.y = row.y;
+        entry.z = row.z;
+
+        if (is2D) {
+            // Capture the first encountered y-coordinate as the reference slice
+            if (std::isnan(y_ref)) {
+                y_ref = entry.y;
+            }
+
+            // Skip all points not from the selected y-slice
+            if (std::abs(entry.y - y_ref) > 1e-6) return;
 
-        if (called_timesteps.count(0) == 0 && t0 == 0) {
-            callback(0, wf0, wf0, wf1);
-            called_timesteps.insert(0);
+            // Collapse y to 0.0 for clean 2D wavefield alignment
+            entry.y = 0.0;
         }
 
-        std::vector<WavefieldEntry> dummy_next;
-        if (called_timesteps.count(t1) == 0) {
-            callback(t1, wf0, wf1, dummy_next);
-            called_timesteps.insert(t1);
+        // Convert from REEF3D vertical system to OpenFAST convention (z=0 at SWL, negative downward)
+        // (elevation is shifted in double before it is narrowed to Value)
+        entry.z = round_to(entry.z - z_max);
+        entry.elevation = round_to(row.elevation - z_max);
+
+        window.push(timestep, entry);
+    }
+
+private:
+    double z_max;
+    bool is2D;
+    double y_ref;
+    TimestepWindow& window;
+};
+
+// Rows parsed from one byte range of the CSV
+struct ParsedChunk {
+    std::vector<int> timesteps;
+    std::vector<CachedRow> rows;
+    size_t rows_read = 0;
+    size_t malformed = 0;
+};
+
+// Parses [begin, end) into chunk. Rows whose y differs from y_ref are dropped
+// before the remaining columns are converted (y_ref = NaN keeps every row).
+void parse_chunk(const char* begin, const char* end, double y_ref, ParsedChunk& chunk) {
+    chunk.timesteps.clear();
+    chunk.rows.clear();
+    chunk.malformed = 0;
+
+    WavefieldCsvReader reader(begin, end);
+    while (reader.next()) {
+        if (!std::isnan(y_ref) && std::abs(reader.y() - y_ref) > 1e-6) continue;
+
+        int timestep;
+        CachedRow row;
+        if (!reader.parse(timestep, row)) {
+            ++chunk.malformed;
+            continue;
         }
+
+        chunk.timesteps.push_back(timestep);
+        chunk.rows.push_back(row);
     }
 
-    file.close();
+    chunk.rows_read = reader.rows_read();
+    chunk.malformed += reader.rows_skipped();
 }
 
-// Stream wavefield CSV in 2D: selects a reference y-slice and processes timesteps streamingly
-void stream_wavefield_with_context_2d(
-    const std::string& filename,
-    double z_max,
-    std::function<void(int,
-                       const std::vector<WavefieldEntry>&,
-                       const std::vector<WavefieldEntry>&,
-                       const std::vector<WavefieldEntry>&)> callback)
-{
-    std::ifstream file(filename);
-    if (!file.is_open()) {
+// Parses the CSV in batches: each batch is split into one row-aligned chunk per
+// thread, the chunks are parsed concurrently and then handed to the ingest in
+// file order, so the (prev, curr, next) window sees exactly the sequential row
+// order. Batches end on a timestep boundary where possible, so every batch
+// delivers whole frames. Returns the number of rows read from the file.
+size_t parse_wavefield_csv(const std::string& filename, bool is2D,
+                           RowIngest& ingest, FrameCacheWriter* cache) {
+    MappedFile map;
+    if (!map.open(filename)) {
         throw std::runtime_error("Could not open wavefield CSV: " + filename);
     }
+    map.advise_sequential();
 
-    std::string line;
-    std::getline(file, line); // Skip CSV header
+    const char* const end = map.data() + map.size();
+    const char* pos = skip_csv_header(map.data(), end);
 
-    std::map<int, std::vector<WavefieldEntry>> buffer;
-    std::set<int> called_timesteps;
+    // 2D: the first row defines the reference y-slice; knowing it up front lets
+    // every thread filter its chunk. The cache stores all rows, so no filter then.
     double y_ref = NAN;
+    if (is2D && !cache) {
+        WavefieldCsvReader first(pos, end);
+        if (first.next()) y_ref = first.y();
+    }
 
-    while (std::getline(file, line)) {
-        std::stringstream ss(line);
-        int timestep;
-        char comma;
-        WavefieldEntry entry;
+    int num_threads = 1;
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+    const size_t chunk_bytes = 8u << 20;
+
+    std::vector<ParsedChunk> chunks(num_threads);
+    std::vector<const char*> bounds(num_threads + 1);
+    size_t rows_read = 0;
+    size_t malformed = 0;
+
+    while (pos < end) {
+        bounds[0] = pos;
+        for (int c = 1; c <= num_threads; ++c) {
+            const char* b = bounds[c - 1];
+            bounds[c] = (static_cast<size_t>(end - b) > chunk_bytes) ? align_to_next_row(b + chunk_bytes, end) : end;
+        }
 
-        ss >> timestep >> comma
-           >> entry.vx >> comma
-           >> entry.vy >> comma
-           >> entry.vz >> comma
-           >> entry.pressure >> comma
-           >> entry.elevation >> comma
-           >> entry.x >> comma
-           >> entry.y >> comma
-           >> entry.z;
-
-        // Capture the first encountered y-coordinate as the reference slice
-        if (std::isnan(y_ref)) {
-            y_ref = entry.y;
+        // Cut the batch at the last timestep change inside its final chunk
+        if (bounds[num_threads] < end) {
+            const char* cut = last_timestep_boundary(bounds[num_threads - 1], bounds[num_threads]);
+            if (cut) bounds[num_threads] = cut;
         }
 
-        // Skip all points not from the selected y-slice
-        if (std::abs(entry.y - y_ref) > 1e-6) continue;
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int c = 0; c < num_threads; ++c) {
+            TRACE_SPAN("parse chunk");
+            parse_chunk(bounds[c], bounds[c + 1], y_ref, chunks[c]);
+        }
 
-        // Collapse y to 0.0 for clean 2D wavefield alignment
-        entry.y = 0.0;
+        // Hand over in file order
+        TRACE_SPAN("ingest rows");
+        for (const auto& chunk : chunks) {
+            for (size_t i = 0; i < chunk.rows.size(); ++i) {
+                if (cache) cache->append(chunk.timesteps[i], chunk.rows[i]);
+                ingest.add(chunk.timesteps[i], chunk.rows[i]);
+            }
+            rows_read += chunk.rows_read;
+            malformed += chunk.malformed;
+        }
 
-        entry.z = round_to(entry.z - z_max);
-        entry.elevation = round_to(entry.elevation - z_max);
+        pos = bounds[num_threads];
+    }
 
-        buffer[timestep].push_back(entry);
+    if (malformed > 0) {
+        std::cerr << "[Warning] Skipped " << malformed << " malformed rows in " << filename << "\n";
+    }
 
-        // Process timesteps in order: always t0 first (including t=0)
-        while (buffer.size() >= 3) {
-            auto it = buffer.begin();
-            int t0 = it->first; auto& wf0 = it->second; ++it;
-            int t1 = it->first; auto& wf1 = it->second; ++it;
-            int t2 = it->first; auto& wf2 = it->second;
+    return rows_read;
+}
 
-            if (t0 == 0 && called_timesteps.count(0) == 0) {
-                callback(0, wf0, wf0, wf1);  // Special handling for t=0
-                called_timesteps.insert(0);
-            }
+void stream_wavefield(const std::string& filename,
+                      double z_max,
+                      bool is2D,
+                      const SharedFrameCallback& callback,
+                      bool use_frame_cache)
+{
+    // Time spent inside the callback is excluded from the ingest rate
+    double callback_seconds = 0.0;
+    SharedFrameCallback timed_callback = [&](int t,
+                                             const SharedFrame& prev,
+                                             const SharedFrame& curr,
+                                             const SharedFrame& next) {
+        auto start = std::chrono::steady_clock::now();
+        callback(t, prev, curr, next);
+        callback_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    auto ingest_start = std::chrono::steady_clock::now();
+
+    TimestepWindow window(timed_callback);
+    RowIngest ingest(z_max, is2D, window);
+
+    size_t rows_read = 0;
+    bool from_cache = use_frame_cache &&
+        read_frame_cache(filename, [&](int timestep, const CachedRow* rows, size_t n) {
+            TRACE_SPAN("ingest cached rows", timestep);
+            for (size_t i = 0; i < n; ++i) ingest.add(timestep, rows[i]);
+            rows_read += n;
+        });
+
+    if (!from_cache) {
+        std::unique_ptr<FrameCacheWriter> cache;
+        if (use_frame_cache) cache = std::make_unique<FrameCacheWriter>(filename);
+
+        rows_read = parse_wavefield_csv(filename, is2D, ingest, cache.get());
+        if (cache) cache->finalize();
+    }
 
-            if (called_timesteps.count(t1) == 0) {
-                callback(t1, wf0, wf1, wf2);
-                called_timesteps.insert(t1);
-            }
+    window.finish();
 
-            buffer.erase(t0);  // Slide window
-        }
-    }
+    double total_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - ingest_start).count();
+    double ingest_seconds = std::max(total_seconds - callback_seconds, 1e-9);
+    std::cout << "\nIngest: " << rows_read << " rows in " << ingest_seconds << " s ("
+              << static_cast<long long>(rows_read / ingest_seconds) << " rows/s)\n";
+}
 
-    // Final fallback: process the last two remaining timesteps
-    if (buffer.size() >= 2) {
-        auto it = buffer.begin();
-        int t0 = it->first; auto& wf0 = it->second; ++it;
-        int t1 = it->first; auto& wf1 = it->second;
+// Adapts a callback on the window's frames to the shared frames of the stream
+SharedFrameCallback by_reference(const FrameCallback& callback) {
+    return [&callback](int t, const SharedFrame& prev, const SharedFrame& curr, const SharedFrame& next) {
+        callback(t, *prev, *curr, *next);
+    };
+}
 
-        if (called_timesteps.count(0) == 0 && t0 == 0) {
-            callback(0, wf0, wf0, wf1);
-            called_timesteps.insert(0);
-        }
+} // namespace
 
-        std::vector<WavefieldEntry> dummy_next;
-        if (called_timesteps.count(t1) == 0) {
-            callback(t1, wf0, wf1, dummy_next);
-            called_timesteps.insert(t1);
-        }
-    }
+// Stream wavefield CSV in 3D: passes (prev, curr, next) to the callback as they become available
+void stream_wavefield_with_context(
+    const std::string& filename,
+    double z_max,
+    std::function<void(int,
+                       const std::vector<WavefieldEntry>&,
+                       const std::vector<WavefieldEntry>&,
+                       const std::vector<WavefieldEntry>&)> callback,
+    bool use_frame_cache)
+{
+    stream_wavefield(filename, z_max, false, by_reference(callback), use_frame_cache);
+}
 
-    file.close();
+// Stream wavefield CSV in 2D: selects a reference y-slice and processes timesteps streamingly
+void stream_wavefield_with_context_2d(
+    const std::string& filename,
+    double z_max,
+    std::function<void(int,
+                       const std::vector<WavefieldEntry>&,
+                       const std::vector<WavefieldEntry>&,
+                       const std::vector<WavefieldEntry>&)> callback,
+    bool use_frame_cache)
+{
+    stream_wavefield(filename, z_max, true, by_reference(callback), use_frame_cache);
+}
+
+// Stream wavefield CSV in 3D, handing the frames themselves to the callback
+void stream_wavefield_frames(
+    const std::string& filename,
+    double z_max,
+    SharedFrameCallback callback,
+    bool use_frame_cache)
+{
+    stream_wavefield(filename, z_max, false, callback, use_frame_cache);
+}
+
+// Stream wavefield CSV in 2D, handing the frames themselves to the callback
+void stream_wavefield_frames_2d(
+    const std::string& filename,
+    double z_max,
+    SharedFrameCallback callback,
+    bool use_frame_cache)
+{
+    stream_wavefield(filename, z_max, true, callback, use_frame_cache);
 }
\ No newline at end of file
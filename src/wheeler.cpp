@@ -1,31 +1,26 @@
 #include "wheeler.hpp"
 #include <cmath>
-#include <algorithm> // for std::max
-#include <iostream>
 
-// Wheeler stretching for all points above SWL  (z > 0)
-void apply_wheeler_stretching(std::vector<WavefieldEntry>& wavefield, double h) {
-    int num_stretched = 0;
+void wheeler_inverse_targets(const std::vector<std::array<double, 3>>& targets,
+                             const std::vector<Value>& eta,
+                             double h,
+                             std::vector<size_t>& moved,
+                             std::vector<std::array<double, 3>>& queries) {
+    moved.clear();
+    queries.clear();
 
-    for (auto& entry : wavefield) {
-        if (entry.z > 0.0) {
-            double eta = entry.elevation;
+    // no division by 0
+    if (std::abs(h) < 1e-6) return;
 
-            // no division by 0
-            double denom = h + eta;
-            if (std::abs(denom) < 1e-6) {
-                continue; // skip stretching for this point
-            }
+    for (size_t i = 0; i < targets.size(); ++i) {
+        // Points with h + eta ~ 0 are never stretched
+        double depth = h + eta[i];
+        if (std::abs(depth) < 1e-6) continue;
 
-            double stretched_z = h * (h + entry.z) / denom - h;
-            entry.z = stretched_z;
-            ++num_stretched; 
+        double z = (targets[i][2] + h) * depth / h - h;
+        if (z > 0.0) {
+            moved.push_back(i);
+            queries.push_back({targets[i][0], targets[i][1], z});
         }
     }
-
-    // Debugging to look at Wheeler
-    if (num_stretched > 0) {
-        std::cout << "Wheeler applied his stretching to " << num_stretched
-                  << " points (z > 0 && eta > 0)" << std::endl;
-    }
 }
\ No newline at end of file
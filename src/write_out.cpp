@@ -1,38 +1,51 @@
 #include "write_out.hpp"
 #include "common.hpp"
-#include <fstream>
+#include <cstdio>
 #include <iostream>
 
-bool write_out_csv(const std::vector<WavefieldEntry>& timestep_data,
+// Appends a value the way std::ostream prints a double by default (%g)
+static void append_value(std::string& out, double value) {
+    char buf[32];
+    int n = std::snprintf(buf, sizeof(buf), "%g", value);
+    out.append(buf, n);
+}
+
+bool write_out_csv(OutputWriter& writer,
+                   const GridFrame& frame,
                    const std::string& filename,
                    int timestep,
-                   bool append) {
-    std::ofstream out;
-
-    if (append) {
-        out.open(filename, std::ios::app);
-    } else {
-        out.open(filename);
-    }
+                   bool append,
+                   const std::vector<double>& y_slices) {
+    std::string* buffer = writer.buffer(filename, append);
 
-    if (!out.is_open()) {
+    if (!buffer) {
         std::cerr << "[write_out_csv] Error: Could not open " << filename << " for writing.\n";
         return false;
     }
 
     // Write header if not appending
+    std::string& out = *buffer;
     if (!append) {
-        out << "timestep,x,y,z,vx,vy,vz,pressure,elevation,ax,ay,az\n";
+        out += "timestep,x,y,z,vx,vy,vz,pressure,elevation,ax,ay,az\n";
     }
 
-    for (const auto& e : timestep_data) {
-        out << timestep << ","
-            << e.x << "," << e.y << "," << e.z << ","
-            << e.vx << "," << e.vy << "," << e.vz << ","
-            << e.pressure << "," << e.elevation << ","
-            << e.ax << "," << e.ay << "," << e.az << "\n";
+    const GridGeometry& grid = *frame.grid;
+    const std::string prefix = std::to_string(timestep) + ",";
+    const size_t slices = y_slices.empty() ? 1 : y_slices.size();
+    for (size_t j = 0; j < slices; ++j) {
+        for (size_t i = 0; i < frame.size(); ++i) {
+            const double y = y_slices.empty() ? grid.y[i] : y_slices[j];
+            const double row[] = {grid.x[i], y, grid.z[i],
+                                  frame.vx[i], frame.vy[i], frame.vz[i],
+                                  frame.pressure[i], frame.elevation[i],
+                                  frame.ax[i], frame.ay[i], frame.az[i]};
+            out += prefix;
+            for (size_t c = 0; c < 11; ++c) {
+                append_value(out, row[c]);
+                out += (c + 1 < 11) ? ',' : '\n';
+            }
+        }
     }
 
-    out.close();
     return true;
 }
\ No newline at end of file
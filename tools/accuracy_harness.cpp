@@ -0,0 +1,319 @@
+// accuracy_harness.cpp
+//
+// Accuracy versus cost of pipeline configurations on analytic waves:
+//
+//   reef2fast_accuracy [options]
+//
+// --control FILE     control.txt of the case (default: see harness.hpp)
+// --ctrl FILE        ctrl.txt of the case (default: see harness.hpp)
+// --theory T,...     airy, stokes2 (default both)
+// --height H         wave height in m (default Hs of ctrl.txt)
+// --period T         wave period in s (default Tp of ctrl.txt)
+// --timesteps N      frames per run (default 32)
+// --refine R,...     raw cells per SeaState cell (default 1,2)
+// --elevation M,...  elevation modes e, z (default both)
+// --wheeler W,...    Wheeler stretching n, y (default both)
+// --order O,...      acceleration stencil orders 2, 4 (default 2)
+// --fields F,...     outputs that count for --target (default all of
+//                    Vx,Vy,Vz,Ax,Ay,Az,DynP,Elev)
+// --target E         report the cheapest configuration with NMAE <= E
+// --work-dir DIR     case directories and wavefield CSVs (default reef2fast_accuracy)
+// --csv FILE         also write every configuration as one CSV line
+//
+// For every theory and refinement a wavefield is synthesised on the raw NHFLOW
+// grid, then every configuration runs the full pipeline on it (one child
+// process per run, see harness.hpp). The SeaState files are compared to the
+// analytic wave at their grid points: NMAE = sum |output - exact| / sum |exact|
+// over all timesteps and wet points (points above the exact free surface are
+// skipped). Outputs without an exact signal (e.g. Vy of a wave along x) print
+// as "-". Cost is the wall time and peak memory of the run.
+
+#include "harness.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+enum Output { VX, VY, VZ, AX, AY, AZ, DYNP, ELEV, NUM_OUTPUTS };
+const char* OUTPUT_NAMES[NUM_OUTPUTS] = {"Vx", "Vy", "Vz", "Ax", "Ay", "Az", "DynP", "Elev"};
+const char* OUTPUT_FILES[NUM_OUTPUTS] = {"REEF2FAST.Vxi", "REEF2FAST.Vyi", "REEF2FAST.Vzi",
+                                         "REEF2FAST.Axi", "REEF2FAST.Ayi", "REEF2FAST.Azi",
+                                         "REEF2FAST.DynP", "REEF2FAST.Elev"};
+
+struct ErrorSum {
+    double error = 0.0;
+    double exact = 0.0;
+
+    double nmae() const {
+        return exact > 0.0 ? error / exact : std::numeric_limits<double>::quiet_NaN();
+    }
+};
+
+struct Config {
+    WaveTheory theory;
+    double refine;
+    size_t points;
+    std::string elevation_mode;
+    bool wheeler;
+    int order;
+    double nmae[NUM_OUTPUTS];
+    double worst;                // largest NMAE of the --fields outputs
+    PipelineRunResult run;
+};
+
+struct Options {
+    std::string control_text = DEFAULT_HARNESS_CONTROL;
+    std::string ctrl_text = DEFAULT_HARNESS_CTRL;
+    std::vector<WaveTheory> theories = {WaveTheory::AIRY, WaveTheory::STOKES2};
+    double height = 0.0;
+    double period = 0.0;
+    int timesteps = 32;
+    std::vector<double> refine = {1.0, 2.0};
+    std::vector<std::string> elevation_modes = {"e", "z"};
+    std::vector<bool> wheeler = {false, true};
+    std::vector<int> orders = {2};
+    bool counts[NUM_OUTPUTS] = {true, true, true, true, true, true, true, true};
+    double target = 0.0;
+    fs::path work_dir = "reef2fast_accuracy";
+    std::string csv_file;
+};
+
+// Exact value of a kinematics output at (x, y, z), time t
+double exact_kinematics(const SyntheticWave& wave, Output output, double x, double y, double z, double t) {
+    double v[4];
+    if (output == AX || output == AY || output == AZ) {
+        wave.acceleration(x, y, z, t, v[0], v[1], v[2]);
+        return v[output - AX];
+    }
+    wave.kinematics(x, y, z, t, v[0], v[1], v[2], v[3]);
+    return (output == DYNP) ? v[3] : v[output - VX];
+}
+
+// Numbers of a header line "! a b c ... - <label>"
+std::vector<double> header_numbers(const std::string& line) {
+    std::vector<double> values;
+    std::istringstream in(line.substr(1, line.rfind(" - ") - 1));
+    double v;
+    while (in >> v) values.push_back(v);
+    return values;
+}
+
+// Value of "<key> = <number>" in a row label
+double label_value(const std::string& label, const std::string& key) {
+    const size_t pos = label.find(key + " = ");
+    if (pos == std::string::npos) throw std::runtime_error("Row label without " + key + ": " + label);
+    return std::strtod(label.c_str() + pos + key.size() + 3, nullptr);
+}
+
+// Compares one SeaState file with the exact wave. Kinematics rows are
+// "values ! All X values at Y = y, Z = z, Time = t" below an X-Locations
+// header; .Elev rows are "values ! Y = y, Time = t" below X positions.
+ErrorSum compare_output(const std::string& path, Output output, const SyntheticWave& wave) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("Could not open " + path);
+
+    ErrorSum sum;
+    std::vector<double> xs;
+    std::string line;
+    while (std::getline(file, line)) {
+        const size_t comment = line.find('!');
+        if (comment == std::string::npos) continue;
+        if (comment == 0) {
+            if (line.find("- X-Locations") != std::string::npos || line.find("- X positions") != std::string::npos) {
+                xs = header_numbers(line);
+            }
+            continue;
+        }
+
+        const std::string label = line.substr(comment);
+        const double y = label_value(label, "Y");
+        const double t = label_value(label, "Time");
+        const double z = (output == ELEV) ? 0.0 : label_value(label, "Z");
+
+        std::istringstream row(line.substr(0, comment));
+        double value;
+        for (size_t i = 0; i < xs.size() && row >> value; ++i) {
+            const double x = xs[i];
+            double exact;
+            if (output == ELEV) {
+                exact = wave.elevation(x, y, t);
+            } else {
+                if (z > wave.elevation(x, y, t)) continue;   // dry point
+                exact = exact_kinematics(wave, output, x, y, z, t);
+            }
+            sum.error += std::abs(value - exact);
+            sum.exact += std::abs(exact);
+        }
+    }
+    return sum;
+}
+
+Config run_config(const Options& opt, const SyntheticCase& c, WaveTheory theory, double refine,
+                  const std::string& elevation_mode, bool wheeler, int order) {
+    Config cfg{theory, refine, c.grid.points(), elevation_mode, wheeler, order, {}, 0.0, {}};
+
+    PipelineRunOptions run;
+    run.elevation_mode = elevation_mode;
+    run.wheeler = wheeler;
+    run.acceleration_order = order;
+    cfg.run = run_pipeline_case(c, run);
+
+    for (int o = 0; o < NUM_OUTPUTS; ++o) {
+        cfg.nmae[o] = compare_output((c.dir / "output" / OUTPUT_FILES[o]).string(), static_cast<Output>(o), c.wave).nmae();
+        if (opt.counts[o] && !std::isnan(cfg.nmae[o])) cfg.worst = std::max(cfg.worst, cfg.nmae[o]);
+    }
+    return cfg;
+}
+
+void print_config_header() {
+    std::cout << std::left << std::setw(9) << "theory" << std::right << std::setw(7) << "refine"
+              << std::setw(10) << "points" << std::setw(6) << "elev" << std::setw(8) << "wheeler"
+              << std::setw(6) << "order";
+    for (const char* name : OUTPUT_NAMES) std::cout << std::setw(10) << name;
+    std::cout << std::setw(10) << "worst" << std::setw(9) << "wall_s" << std::setw(9) << "peak_MB" << "\n";
+}
+
+void print_config(const Config& c) {
+    std::cout << std::left << std::setw(9) << wave_theory_name(c.theory) << std::right
+              << std::setw(7) << c.refine << std::setw(10) << c.points << std::setw(6) << c.elevation_mode
+              << std::setw(8) << (c.wheeler ? "y" : "n") << std::setw(6) << c.order
+              << std::scientific << std::setprecision(2);
+    for (double nmae : c.nmae) {
+        if (std::isnan(nmae)) std::cout << std::setw(10) << "-";
+        else std::cout << std::setw(10) << nmae;
+    }
+    std::cout << std::setw(10) << c.worst << std::fixed << std::setprecision(3)
+              << std::setw(9) << c.run.times.total << std::setprecision(1) << std::setw(9) << c.run.peak_mb
+              << std::defaultfloat << "\n";
+}
+
+std::vector<std::string> split_list(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) items.push_back(item);
+    return items;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+            const std::string value = argv[++i];
+            if (arg == "--control") opt.control_text = read_text_file(value);
+            else if (arg == "--ctrl") opt.ctrl_text = read_text_file(value);
+            else if (arg == "--height") opt.height = parse_number_list<double>(arg, value).at(0);
+            else if (arg == "--period") opt.period = parse_number_list<double>(arg, value).at(0);
+            else if (arg == "--timesteps") opt.timesteps = parse_number_list<int>(arg, value).at(0);
+            else if (arg == "--refine") opt.refine = parse_number_list<double>(arg, value);
+            else if (arg == "--order") opt.orders = parse_number_list<int>(arg, value);
+            else if (arg == "--target") opt.target = parse_number_list<double>(arg, value).at(0);
+            else if (arg == "--work-dir") opt.work_dir = value;
+            else if (arg == "--csv") opt.csv_file = value;
+            else if (arg == "--theory") {
+                opt.theories.clear();
+                for (const std::string& name : split_list(value)) opt.theories.push_back(parse_wave_theory(name));
+            } else if (arg == "--elevation") {
+                opt.elevation_modes = split_list(value);
+                for (const std::string& mode : opt.elevation_modes) {
+                    if (mode != "e" && mode != "z") throw std::invalid_argument("elevation mode must be e or z: " + mode);
+                }
+            } else if (arg == "--wheeler") {
+                opt.wheeler.clear();
+                for (const std::string& w : split_list(value)) {
+                    if (w != "n" && w != "y") throw std::invalid_argument("--wheeler takes n and/or y: " + w);
+                    opt.wheeler.push_back(w == "y");
+                }
+            } else if (arg == "--fields") {
+                std::fill(std::begin(opt.counts), std::end(opt.counts), false);
+                for (const std::string& name : split_list(value)) {
+                    const auto it = std::find_if(std::begin(OUTPUT_NAMES), std::end(OUTPUT_NAMES),
+                                                 [&](const char* n) { return name == n; });
+                    if (it == std::end(OUTPUT_NAMES)) throw std::invalid_argument("unknown output " + name);
+                    opt.counts[it - std::begin(OUTPUT_NAMES)] = true;
+                }
+            } else throw std::invalid_argument("unknown option " + arg);
+        }
+        for (int order : opt.orders) {
+            if (order != 2 && order != 4) throw std::invalid_argument("acceleration order must be 2 or 4");
+        }
+        if (opt.timesteps < 2) throw std::invalid_argument("at least 2 timesteps are needed");
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n"
+                  << "Usage: " << argv[0] << " [--control FILE] [--ctrl FILE] [--theory airy,stokes2]"
+                  << " [--height H] [--period T] [--timesteps N] [--refine R,...] [--elevation e,z]"
+                  << " [--wheeler n,y] [--order 2,4] [--fields F,...] [--target E] [--work-dir DIR] [--csv FILE]\n";
+        return 2;
+    }
+
+    std::vector<Config> configs;
+    try {
+        for (WaveTheory theory : opt.theories) {
+            for (double refine : opt.refine) {
+                std::ostringstream name;
+                name << wave_theory_name(theory) << "_refine_" << refine;
+                const SyntheticCase c = prepare_synthetic_case(opt.work_dir / name.str(), opt.control_text,
+                                                               opt.ctrl_text, refine, opt.timesteps, theory,
+                                                               opt.height, opt.period);
+                for (const std::string& mode : opt.elevation_modes) {
+                    for (bool wheeler : opt.wheeler) {
+                        for (int order : opt.orders) {
+                            std::cerr << "Running " << name.str() << ", elevation " << mode << ", Wheeler "
+                                      << (wheeler ? "y" : "n") << ", order " << order << "\n";
+                            configs.push_back(run_config(opt, c, theory, refine, mode, wheeler, order));
+                        }
+                    }
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    std::cout << "\nNMAE of the SeaState outputs against the exact wave\n";
+    print_config_header();
+    for (const Config& c : configs) print_config(c);
+
+    if (opt.target > 0.0) {
+        std::cout << "\nCheapest configuration with NMAE <= " << opt.target << " (by wall time)\n";
+        for (WaveTheory theory : opt.theories) {
+            const Config* best = nullptr;
+            for (const Config& c : configs) {
+                if (c.theory != theory || c.worst > opt.target) continue;
+                if (!best || c.run.times.total < best->run.times.total) best = &c;
+            }
+            if (best) print_config(*best);
+            else std::cout << wave_theory_name(theory) << ": no configuration meets the target\n";
+        }
+    }
+
+    if (!opt.csv_file.empty()) {
+        std::ofstream csv(opt.csv_file);
+        csv << "theory,refine,points,elevation,wheeler,order";
+        for (const char* name : OUTPUT_NAMES) csv << ",nmae_" << name;
+        csv << ",wall_s,ingest_s,compute_s,write_s,peak_mb\n";
+        for (const Config& c : configs) {
+            csv << wave_theory_name(c.theory) << "," << c.refine << "," << c.points << "," << c.elevation_mode
+                << "," << (c.wheeler ? "y" : "n") << "," << c.order;
+            for (double nmae : c.nmae) csv << "," << nmae;
+            csv << "," << c.run.times.total << "," << c.run.times.ingest << "," << c.run.times.compute
+                << "," << c.run.times.write << "," << c.run.peak_mb << "\n";
+        }
+    }
+
+    return 0;
+}
\ No newline at end of file
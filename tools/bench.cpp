@@ -0,0 +1,480 @@
+// bench.cpp
+//
+// Micro-benchmarks of the hot paths of REEF2FAST on synthetic NHFLOW frames:
+//
+//   reef2fast_bench [--points N,N,...] [--threads T,T,...] [--reps R] [--filter TEXT]
+//
+// --points   raw points per frame (default 20000,80000,320000)
+// --threads  OpenMP thread counts (default 1 and the maximum)
+// --reps     timed repetitions after one warm-up run (default 5)
+// --filter   only run benchmarks whose name contains TEXT
+//
+// The frames are a sigma grid of 20 levels under a linear Airy wave (no random
+// input), the targets a SeaState grid with one target per 8 raw points, so
+// every run sees the same data. The fused acceleration benchmarks run on the
+// same wave on a static grid (sigma levels at still water), the only layout
+// the fused path accepts. Results go to stdout as CSV, one line per
+// benchmark, point count and thread count:
+//
+//   benchmark,points,targets,threads,reps,min_ms,median_ms,mean_ms,items_per_s
+//
+// items_per_s is based on min_ms; the item is given per benchmark below
+// (rows, targets or formatted values).
+
+#include "acc.hpp"
+#include "cloud.hpp"
+#include "cloud2d.hpp"
+#include "common.hpp"
+#include "export.hpp"
+#include "scientific_format.hpp"
+#include "seastate_layout.hpp"
+#include "spatial_index.hpp"
+#include "structs.hpp"
+#include "surface_elevation.hpp"
+#include "wavefield_csv.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+
+// Wave of the synthetic frames
+constexpr double DEPTH = 20.0;
+constexpr double AMPLITUDE = 0.75;
+constexpr double WAVE_NUMBER = 2.0 * M_PI / 50.0;
+constexpr double OMEGA = 2.0 * M_PI / 8.0;
+constexpr double WAVE_DT = 0.25;
+constexpr double LENGTH = 200.0;         // domain length in x (and y in 3D)
+constexpr int SIGMA_LEVELS = 20;
+constexpr int TARGET_LEVELS = 10;
+
+// Raw frames around t = 1 s and the SeaState grid of one benchmark case
+struct BenchCase {
+    bool is2D = false;
+    Wavefield frames[5];                 // t - 2 dt ... t + 2 dt
+    Wavefield static_frames[5];          // the same on a static grid: only the values change
+    std::vector<std::array<double, 3>> targets;
+    GridGeometry grid;
+    std::string csv;                     // frames[2] as REEF3D CSV rows
+    size_t csv_rows = 0;
+
+    const Wavefield& curr() const { return frames[2]; }
+};
+
+// moving = false keeps the sigma levels at still water (static raw grid)
+Wavefield make_frame(int nx, int ny, double t, bool is2D, bool moving) {
+    Wavefield frame;
+    frame.reserve(static_cast<size_t>(nx) * ny * SIGMA_LEVELS);
+    for (int i = 0; i < nx; ++i) {
+        const double x = LENGTH * i / (nx - 1);
+        for (int j = 0; j < ny; ++j) {
+            const double y = is2D ? 0.0 : LENGTH * j / (ny - 1) - 0.5 * LENGTH;
+            const double eta = AMPLITUDE * std::cos(WAVE_NUMBER * x + 0.01 * y - OMEGA * t);
+            for (int l = 0; l < SIGMA_LEVELS; ++l) {
+                const double z = -DEPTH + (DEPTH + (moving ? eta : 0.0)) * l / (SIGMA_LEVELS - 1);
+                const double decay = AMPLITUDE * OMEGA * std::exp(WAVE_NUMBER * z);
+                const double phase = WAVE_NUMBER * x - OMEGA * t;
+
+                WavefieldEntry e;
+                e.x = x;
+                e.y = y;
+                e.z = z;
+                e.vx = static_cast<Value>(decay * std::cos(phase));
+                e.vy = is2D ? 0.0 : static_cast<Value>(0.05 * decay * std::cos(phase));
+                e.vz = static_cast<Value>(decay * std::sin(phase));
+                e.pressure = static_cast<Value>(1025.0 * 9.81 * decay / OMEGA * std::cos(phase));
+                e.elevation = static_cast<Value>(eta);
+                frame.push_back(e);
+            }
+        }
+    }
+    return frame;
+}
+
+BenchCase make_case(size_t points, bool is2D) {
+    BenchCase c;
+    c.is2D = is2D;
+
+    const double columns = static_cast<double>(points) / SIGMA_LEVELS;
+    const int nx = std::max(2, static_cast<int>(is2D ? columns : std::sqrt(columns)));
+    const int ny = is2D ? 1 : nx;
+    for (int f = 0; f < 5; ++f) {
+        c.frames[f] = make_frame(nx, ny, 1.0 + (f - 2) * WAVE_DT, is2D, true);
+        c.static_frames[f] = make_frame(nx, ny, 1.0 + (f - 2) * WAVE_DT, is2D, false);
+    }
+
+    // SeaState grid: half the raw resolution horizontally, levels down to the bed
+    const int tx = std::max(2, nx / 2);
+    const int ty = is2D ? 1 : std::max(2, ny / 2);
+    for (int l = 0; l < TARGET_LEVELS; ++l) {
+        const double z = -DEPTH * (1.0 - std::sin(0.5 * M_PI * l / (TARGET_LEVELS - 1)));
+        for (int j = 0; j < ty; ++j) {
+            const double y = is2D ? 0.0 : LENGTH * j / (ty - 1) - 0.5 * LENGTH;
+            for (int i = 0; i < tx; ++i) {
+                c.targets.push_back({LENGTH * i / (tx - 1), y, z});
+            }
+        }
+    }
+    for (const auto& p : c.targets) {
+        c.grid.x.push_back(p[0]);
+        c.grid.y.push_back(p[1]);
+        c.grid.z.push_back(p[2]);
+    }
+
+    // Column layout: timestep,u,v,w,pressure,elevation,x,y,z
+    std::ostringstream csv;
+    csv << "TimeStep,velocity:0,velocity:1,velocity:2,pressure,elevation,Points:0,Points:1,Points:2\n";
+    char line[256];
+    for (const WavefieldEntry& e : c.curr()) {
+        std::snprintf(line, sizeof(line), "4,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g\n",
+                      static_cast<double>(e.vx), static_cast<double>(e.vy), static_cast<double>(e.vz),
+                      static_cast<double>(e.pressure), static_cast<double>(e.elevation) + DEPTH,
+                      e.x, e.y, e.z + DEPTH);
+        csv << line;
+    }
+    c.csv = csv.str();
+    c.csv_rows = c.curr().size();
+    return c;
+}
+
+struct Timing {
+    double min_ms, median_ms, mean_ms;
+};
+
+// One warm-up run, then reps timed runs
+Timing measure(int reps, const std::function<void()>& fn) {
+    fn();
+    std::vector<double> ms;
+    for (int r = 0; r < reps; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(ms.begin(), ms.end());
+    const double mean = std::accumulate(ms.begin(), ms.end(), 0.0) / ms.size();
+    const double median = (ms.size() % 2) ? ms[ms.size() / 2]
+                                          : 0.5 * (ms[ms.size() / 2 - 1] + ms[ms.size() / 2]);
+    return {ms.front(), median, mean};
+}
+
+// Keeps results alive so the compiler cannot drop the measured work
+volatile double sink = 0.0;
+
+void consume(const std::vector<Value>& column) {
+    if (!column.empty()) sink = sink + static_cast<double>(column[column.size() / 2]);
+}
+
+// A benchmark returns the number of items one run processes
+struct Benchmark {
+    const char* name;
+    bool is2D;
+    std::function<size_t(const BenchCase&, int reps, Timing&)> run;
+};
+
+const unsigned ALL_FIELDS = FIELD_VX | FIELD_VY | FIELD_VZ | FIELD_PRESSURE;
+
+// Stencil of the static frames around t
+AccelerationFrames static_stencil(const BenchCase& c) {
+    AccelerationFrames frames;
+    frames.prev2 = &c.static_frames[0];
+    frames.prev = &c.static_frames[1];
+    frames.curr = &c.static_frames[2];
+    frames.next = &c.static_frames[3];
+    frames.next2 = &c.static_frames[4];
+    return frames;
+}
+
+// Fused interpolation that must not fall back, or the benchmark times a no-op
+void fused_interpolation(const AccelerationFrames& frames, const NeighbourList& neighbours,
+                         int order, GridFrame& frame) {
+    if (!interpolate_fields_with_acceleration(frames, neighbours, ALL_FIELDS, WAVE_DT, order, frame)) {
+        throw std::runtime_error("fused interpolation rejected the static frames");
+    }
+}
+
+std::vector<Benchmark> benchmarks() {
+    std::vector<Benchmark> list;
+
+    // Items: CSV rows. The buffer is split into one row-aligned chunk per thread.
+    list.push_back({"csv_parse", false, [](const BenchCase& c, int reps, Timing& t) {
+        const char* begin = skip_csv_header(c.csv.data(), c.csv.data() + c.csv.size());
+        const char* end = c.csv.data() + c.csv.size();
+        t = measure(reps, [&]() {
+            int chunks = 1;
+#ifdef _OPENMP
+            chunks = omp_get_max_threads();
+#endif
+            std::vector<const char*> bounds(chunks + 1, end);
+            bounds[0] = begin;
+            for (int i = 1; i < chunks; ++i) {
+                bounds[i] = align_to_next_row(begin + (end - begin) * i / chunks, end);
+            }
+            double sum = 0.0;
+            #pragma omp parallel for reduction(+:sum) schedule(static, 1)
+            for (int i = 0; i < chunks; ++i) {
+                WavefieldCsvReader reader(bounds[i], std::max(bounds[i], bounds[i + 1]));
+                int timestep;
+                CachedRow row;
+                while (reader.next()) {
+                    if (reader.parse(timestep, row)) sum += row.vx;
+                }
+            }
+            sink = sink + sum;
+        });
+        return c.csv_rows;
+    }});
+
+    // Items: targets. KD-tree build plus kNN (k = 8) and IDW of one field.
+    list.push_back({"interpolate_to_grid", false, [](const BenchCase& c, int reps, Timing& t) {
+        t = measure(reps, [&]() { consume(interpolate_to_grid(c.curr(), c.targets, "vx")); });
+        return c.targets.size();
+    }});
+
+    list.push_back({"interpolate_to_grid_2d", true, [](const BenchCase& c, int reps, Timing& t) {
+        t = measure(reps, [&]() { consume(interpolate_to_grid_2d(c.curr(), c.targets, "vx")); });
+        return c.targets.size();
+    }});
+
+    // Items: targets. Fresh index: tree build and kNN (k = 4) of every target.
+    list.push_back({"spatial_index_query", false, [](const BenchCase& c, int reps, Timing& t) {
+        t = measure(reps, [&]() {
+            SpatialIndex index(3, 4);
+            sink = sink + index.query(c.curr(), c.targets).num_targets();
+        });
+        return c.targets.size();
+    }});
+
+    // Items: targets. IDW of velocity and pressure with given neighbours.
+    list.push_back({"idw_interpolate", false, [](const BenchCase& c, int reps, Timing& t) {
+        SpatialIndex index(3, 4);
+        const NeighbourList& neighbours = index.query(c.curr(), c.targets);
+        GridFrame frame;
+        t = measure(reps, [&]() {
+            interpolate_fields(c.curr(), neighbours, ALL_FIELDS, frame);
+            consume(frame.vx);
+        });
+        return c.targets.size();
+    }});
+
+    // Items: targets. IDW of velocity, pressure and acceleration in one pass (static grid).
+    for (int order : {2, 4}) {
+        list.push_back({order == 2 ? "idw_fused_acceleration" : "idw_fused_acceleration_o4", false,
+                        [order](const BenchCase& c, int reps, Timing& t) {
+            const AccelerationFrames frames = static_stencil(c);
+            SpatialIndex index(3, 4);
+            const NeighbourList& neighbours = index.query(*frames.curr, c.targets);
+            GridFrame frame;
+            t = measure(reps, [&]() {
+                fused_interpolation(frames, neighbours, order, frame);
+                consume(frame.ax);
+            });
+            return c.targets.size();
+        }});
+    }
+
+    // Items: targets. Central difference of interpolated frames.
+    list.push_back({"acceleration_from_context", false, [](const BenchCase& c, int reps, Timing& t) {
+        GridFrame interp[3];
+        for (int f = 0; f < 3; ++f) {
+            SpatialIndex index(3, 4);
+            interpolate_fields(c.frames[f + 1], index.query(c.frames[f + 1], c.targets), ALL_FIELDS, interp[f]);
+        }
+        t = measure(reps, [&]() {
+            computeAcceleration_from_context(interp[0], interp[1], interp[2], WAVE_DT);
+            consume(interp[1].ax);
+        });
+        return c.targets.size();
+    }});
+
+    // Items: targets. Elevation with the column plan reused (steady state) ...
+    for (auto source : {SurfaceElevation::Source::GEOMETRIC, SurfaceElevation::Source::REEF3D}) {
+        const bool geometric = (source == SurfaceElevation::Source::GEOMETRIC);
+        list.push_back({geometric ? "surface_elevation_z" : "surface_elevation_e", false,
+                        [source](const BenchCase& c, int reps, Timing& t) {
+            SurfaceElevation elevation(2, source);
+            GridFrame frame;
+            frame.grid = &c.grid;
+            t = measure(reps, [&]() {
+                elevation.compute(frame, c.curr());
+                consume(frame.elevation);
+            });
+            return c.targets.size();
+        }});
+    }
+
+    // ... and with the plan built in every run
+    list.push_back({"surface_elevation_plan", false, [](const BenchCase& c, int reps, Timing& t) {
+        GridFrame frame;
+        frame.grid = &c.grid;
+        t = measure(reps, [&]() {
+            SurfaceElevation elevation(2, SurfaceElevation::Source::REEF3D);
+            elevation.compute(frame, c.curr());
+            consume(frame.elevation);
+        });
+        return c.targets.size();
+    }});
+
+    // Items: formatted values ("%.4e" of the seven SeaState fields), with the
+    // allocation-free formatter and with the std::string one
+    auto seastate_values = [](const BenchCase& c) {
+        std::vector<Value> values;
+        for (const WavefieldEntry& e : c.curr()) {
+            if (values.size() == 7 * c.targets.size()) break;
+            values.insert(values.end(), {e.vx, e.vy, e.vz, e.vx, e.vy, e.vz, e.pressure});
+        }
+        return values;
+    };
+
+    list.push_back({"write_scientific", false, [seastate_values](const BenchCase& c, int reps, Timing& t) {
+        const std::vector<Value> values = seastate_values(c);
+        std::string text;
+        t = measure(reps, [&]() {
+            text.clear();
+            append_scientific_row(text, values.data(), values.size());
+            sink = sink + text.size();
+        });
+        return values.size();
+    }});
+
+    list.push_back({"format_scientific", false, [seastate_values](const BenchCase& c, int reps, Timing& t) {
+        const std::vector<Value> values = seastate_values(c);
+        std::string text;
+        t = measure(reps, [&]() {
+            text.clear();
+            for (Value v : values) {
+                text += format_scientific(v);
+                text += ' ';
+            }
+            sink = sink + text.size();
+        });
+        return values.size();
+    }});
+
+    // Items: formatted values. One timestep of all seven SeaState files, fixed width.
+    list.push_back({"format_wavefile_blocks", false, [](const BenchCase& c, int reps, Timing& t) {
+        const SeaStateLayout layout = plan_seastate_layout(c.grid, WAVE_DT);
+        GridFrame frame;
+        frame.grid = &c.grid;
+        const AccelerationFrames frames = static_stencil(c);
+        SpatialIndex index(3, 4);
+        fused_interpolation(frames, index.query(*frames.curr, c.targets), 2, frame);
+
+        const size_t block_bytes = wavefile_block_bytes(layout);
+        std::vector<std::vector<char>> blocks(NUM_WAVE_COMPONENTS, std::vector<char>(block_bytes));
+        char* block_ptrs[NUM_WAVE_COMPONENTS];
+        for (size_t i = 0; i < NUM_WAVE_COMPONENTS; ++i) block_ptrs[i] = blocks[i].data();
+        t = measure(reps, [&]() {
+            format_wavefile_blocks(layout, frame, 4, block_ptrs);
+            sink = sink + blocks[0][block_bytes / 2];
+        });
+        return NUM_WAVE_COMPONENTS * c.targets.size();
+    }});
+
+    return list;
+}
+
+std::vector<long> parse_list(const std::string& text) {
+    std::vector<long> values;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        char* end = nullptr;
+        long v = std::strtol(item.c_str(), &end, 10);
+        if (end == item.c_str() || *end != '\0' || v <= 0) {
+            throw std::invalid_argument("not a positive integer: " + item);
+        }
+        values.push_back(v);
+    }
+    return values;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<long> point_counts = {20000, 80000, 320000};
+    std::vector<long> thread_counts = {1};
+    int reps = 5;
+    std::string filter;
+
+#ifdef _OPENMP
+    if (omp_get_max_threads() > 1) thread_counts.push_back(omp_get_max_threads());
+#endif
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+            const std::string value = argv[++i];
+            if (arg == "--points") point_counts = parse_list(value);
+            else if (arg == "--threads") thread_counts = parse_list(value);
+            else if (arg == "--reps") reps = static_cast<int>(parse_list(value).at(0));
+            else if (arg == "--filter") filter = value;
+            else throw std::invalid_argument("unknown option " + arg);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n"
+                  << "Usage: " << argv[0]
+                  << " [--points N,N,...] [--threads T,T,...] [--reps R] [--filter TEXT]\n";
+        return 2;
+    }
+
+#ifndef _OPENMP
+    if (thread_counts != std::vector<long>{1}) {
+        std::cerr << "Built without OpenMP, every benchmark runs on one thread.\n";
+        thread_counts = {1};
+    }
+#endif
+
+    const std::vector<Benchmark> list = benchmarks();
+
+    std::cout << "benchmark,points,targets,threads,reps,min_ms,median_ms,mean_ms,items_per_s\n";
+    for (long points : point_counts) {
+        // Cases are generated on demand, at most one 3D and one 2D case at a time
+        std::unique_ptr<BenchCase> cases[2];
+
+        for (const Benchmark& b : list) {
+            if (!filter.empty() && std::string(b.name).find(filter) == std::string::npos) continue;
+
+            auto& c = cases[b.is2D ? 1 : 0];
+            if (!c) c = std::make_unique<BenchCase>(make_case(static_cast<size_t>(points), b.is2D));
+
+            for (long threads : thread_counts) {
+#ifdef _OPENMP
+                omp_set_num_threads(static_cast<int>(threads));
+#endif
+                Timing t;
+                size_t items = 0;
+                try {
+                    items = b.run(*c, reps, t);
+                } catch (const std::exception& e) {
+                    std::cerr << b.name << ": " << e.what() << "\n";
+                    return 1;
+                }
+
+                char line[256];
+                std::snprintf(line, sizeof(line), "%s,%zu,%zu,%ld,%d,%.4f,%.4f,%.4f,%.4e\n",
+                              b.name, c->curr().size(), c->targets.size(), threads, reps,
+                              t.min_ms, t.median_ms, t.mean_ms,
+                              items / std::max(t.min_ms * 1e-3, 1e-12));
+                std::cout << line << std::flush;
+            }
+        }
+    }
+
+    return 0;
+}
\ No newline at end of file
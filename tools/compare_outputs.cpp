@@ -0,0 +1,118 @@
+// compare_outputs.cpp
+//
+// Error report between two REEF2FAST output directories, e.g. the output of a
+// default (double) build and of a build configured with REEF2FAST_FLOAT_VALUES:
+//
+//   reef2fast_compare <reference_output_dir> <test_output_dir>
+//
+// For every SeaState file the data values (everything before the "!" comment
+// of a data line) are compared one by one.
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct FileValues {
+    std::vector<double> values;
+    std::vector<std::string> tokens;
+};
+
+// Reads all data values of a SeaState file; header lines start with "!" or
+// contain no "!" at all (the two free-text lines)
+static bool read_values(const std::string& path, FileValues& out) {
+    std::ifstream file(path);
+    if (!file) return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t comment = line.find('!');
+        if (comment == std::string::npos || comment == 0) continue;
+
+        std::istringstream row(line.substr(0, comment));
+        std::string token;
+        while (row >> token) {
+            out.tokens.push_back(token);
+            out.values.push_back(std::strtod(token.c_str(), nullptr));
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <reference_output_dir> <test_output_dir>\n";
+        return 2;
+    }
+
+    const std::string ref_dir = argv[1];
+    const std::string test_dir = argv[2];
+    const char* files[] = {"REEF2FAST.Vxi", "REEF2FAST.Vyi", "REEF2FAST.Vzi",
+                           "REEF2FAST.Axi", "REEF2FAST.Ayi", "REEF2FAST.Azi",
+                           "REEF2FAST.DynP", "REEF2FAST.Elev"};
+
+    std::cout << std::left << std::setw(16) << "File"
+              << std::right << std::setw(10) << "Values"
+              << std::setw(10) << "Changed"
+              << std::setw(14) << "Max |err|"
+              << std::setw(14) << "RMS err"
+              << std::setw(14) << "Max |ref|"
+              << std::setw(14) << "Rel. err" << "\n";
+
+    bool mismatch = false;
+    for (const char* name : files) {
+        FileValues ref, test;
+        if (!read_values(ref_dir + "/" + name, ref) || !read_values(test_dir + "/" + name, test)) {
+            std::cout << std::left << std::setw(16) << name << "  missing\n";
+            mismatch = true;
+            continue;
+        }
+        if (ref.values.size() != test.values.size()) {
+            std::cout << std::left << std::setw(16) << name << "  different number of values ("
+                      << ref.values.size() << " vs. " << test.values.size() << ")\n";
+            mismatch = true;
+            continue;
+        }
+
+        // Printed tokens that differ, and the numeric error over finite values
+        size_t changed = 0;
+        double max_err = 0.0, sum_sq = 0.0, max_ref = 0.0;
+        size_t finite = 0;
+        for (size_t i = 0; i < ref.values.size(); ++i) {
+            if (ref.tokens[i] != test.tokens[i]) ++changed;
+
+            double r = ref.values[i], t = test.values[i];
+            if (std::isnan(r) || std::isnan(t)) {
+                if (std::isnan(r) != std::isnan(t)) mismatch = true;
+                continue;
+            }
+            double err = std::abs(t - r);
+            max_err = std::max(max_err, err);
+            max_ref = std::max(max_ref, std::abs(r));
+            sum_sq += err * err;
+            ++finite;
+        }
+        double rms = finite > 0 ? std::sqrt(sum_sq / finite) : 0.0;
+        double rel = max_ref > 0.0 ? max_err / max_ref : 0.0;
+
+        std::cout << std::left << std::setw(16) << name
+                  << std::right << std::setw(10) << ref.values.size()
+                  << std::setw(10) << changed
+                  << std::scientific << std::setprecision(3)
+                  << std::setw(14) << max_err
+                  << std::setw(14) << rms
+                  << std::setw(14) << max_ref
+                  << std::setw(14) << rel
+                  << std::defaultfloat << "\n";
+    }
+
+    if (mismatch) {
+        std::cerr << "Outputs are not comparable (missing files or NaN mismatch).\n";
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
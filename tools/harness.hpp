@@ -0,0 +1,222 @@
+// harness.hpp
+//
+// Shared parts of reef2fast_scaling and reef2fast_accuracy: synthetic cases laid
+// out like a REEF2FAST checkout (data/, build/, output/) and pipeline runs in
+// child processes. Every run is its own process, so it reports its own peak
+// resident memory; the harness process itself never starts OpenMP threads,
+// which do not survive fork().
+#pragma once
+
+#include "common.hpp"
+#include "genSeaState.hpp"
+#include "streamingpipeline.hpp"
+#include "synthetic_wavefield.hpp"
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// 400 m x 200 m x 20 m box with a 40 x 20 x 10 SeaState grid; 1.5 m, 8 s waves sampled every 0.25 s
+inline const char* DEFAULT_HARNESS_CONTROL = "B 2 40 20 10\nB 10 0.0 400.0 -100.0 100.0 0 20.0\n";
+inline const char* DEFAULT_HARNESS_CTRL = "B 93 1.5 8\nN 41 5.0\nP 30 0.25\n";
+
+// Synthetic case directory with data/control.txt, data/ctrl.txt and data/wave.csv
+struct SyntheticCase {
+    fs::path dir;
+    SyntheticGrid grid;
+    SyntheticWave wave;
+    double dt;
+    int timesteps;
+};
+
+// Options of one pipeline run, as answered at the prompts of an interactive run
+struct PipelineRunOptions {
+    std::string elevation_mode = "e";
+    bool wheeler = false;
+    int workers = 1;
+    int acceleration_order = 2;
+    int threads = 0;              // OpenMP threads, 0 = default
+};
+
+struct PipelineRunResult {
+    StreamingPipeline::StageTimes times;
+    double peak_mb = 0.0;
+};
+
+inline void write_all(int fd, const std::string& text) {
+    size_t done = 0;
+    while (done < text.size()) {
+        const ssize_t n = write(fd, text.data() + done, text.size() - done);
+        if (n <= 0) return;
+        done += static_cast<size_t>(n);
+    }
+}
+
+// Runs fn in a child process, which may report back by writing to out_fd.
+// Returns the child's exit status; output and peak_mb (peak RSS) are filled in.
+inline int run_child(const std::function<void(int out_fd)>& fn, std::string& output, double& peak_mb) {
+    int fds[2];
+    if (pipe(fds) != 0) throw std::runtime_error("pipe() failed");
+
+    const pid_t pid = fork();
+    if (pid < 0) throw std::runtime_error("fork() failed");
+    if (pid == 0) {
+        close(fds[0]);
+        int status = 0;
+        try {
+            fn(fds[1]);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            status = 1;
+        }
+        close(fds[1]);
+        std::cout.flush();
+        _exit(status);
+    }
+
+    close(fds[1]);
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(fds[0], buf, sizeof(buf))) > 0) output.append(buf, static_cast<size_t>(n));
+    close(fds[0]);
+
+    int status = 0;
+    struct rusage usage;
+    wait4(pid, &status, 0, &usage);
+    peak_mb = usage.ru_maxrss / 1024.0;   // kilobytes on Linux
+    return (WIFEXITED(status)) ? WEXITSTATUS(status) : 1;
+}
+
+inline std::string read_text_file(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("Could not open " + path);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+/**
+ * Writes the case files to dir and generates its wavefield: num_timesteps frames
+ * of the regular wave of ctrl_text (height and period > 0 override Hs and Tp)
+ * on the raw grid of control_text with the given refinement. An existing
+ * wavefield generated with the same inputs is reused.
+ */
+inline SyntheticCase prepare_synthetic_case(const fs::path& dir,
+                                            const std::string& control_text,
+                                            const std::string& ctrl_text,
+                                            double refine,
+                                            int num_timesteps,
+                                            WaveTheory theory = WaveTheory::AIRY,
+                                            double height = 0.0,
+                                            double period = 0.0) {
+    fs::create_directories(dir / "data");
+    fs::create_directories(dir / "build");
+    fs::create_directories(dir / "output");
+    const std::string control = (dir / "data" / "control.txt").string();
+    const std::string ctrl = (dir / "data" / "ctrl.txt").string();
+    const std::string csv = (dir / "data" / "wave.csv").string();
+    std::ofstream(control) << control_text;
+    std::ofstream(ctrl) << ctrl_text;
+
+    double sim_time = 0.0, dt = 0.0, hs = 0.0, tp = 0.0;
+    if (!read_wave_parameters(ctrl, sim_time, dt, hs, tp) || dt <= 0.0) {
+        throw std::runtime_error("Could not read WaveDT, Hs and Tp from " + ctrl);
+    }
+    const SyntheticGrid grid = synthetic_grid_from_control(control, refine);
+    SyntheticCase c{dir, grid,
+                    SyntheticWave(height > 0.0 ? height : hs, period > 0.0 ? period : tp,
+                                  grid.z_max - grid.z_min, 0.0, theory),
+                    dt, num_timesteps};
+
+    // Regenerated unless a complete file with the same inputs is already there
+    const std::string stamp_path = (dir / "data" / "wave.stamp").string();
+    std::ostringstream stamp;
+    stamp << control_text << ctrl_text << refine << " " << num_timesteps << " "
+          << wave_theory_name(theory) << " " << height << " " << period;
+    if (fs::exists(csv) && fs::exists(stamp_path) && read_text_file(stamp_path) == stamp.str()) return c;
+
+    std::cerr << "Generating " << csv << " (" << grid.points() << " points x " << num_timesteps << " timesteps)\n";
+    std::string output;
+    double peak_mb;
+    const int status = run_child([&](int) {
+        write_synthetic_wavefield(csv, c.wave, c.grid, c.timesteps, c.dt);
+    }, output, peak_mb);
+    if (status != 0) throw std::runtime_error("Could not generate " + csv);
+
+    std::ofstream(stamp_path) << stamp.str();
+    return c;
+}
+
+/**
+ * Runs the full StreamingPipeline on a case in a child process, started from
+ * build/ like an interactive run (results in output/, stdout discarded).
+ * 2D cases are broadcast to 6 y-points over 40 m. Throws std::runtime_error
+ * if the run fails.
+ */
+inline PipelineRunResult run_pipeline_case(const SyntheticCase& c, const PipelineRunOptions& opt) {
+    PipelineRunResult result;
+    std::string output;
+    const int status = run_child([&](int out_fd) {
+        fs::current_path(c.dir / "build");
+        const int null_fd = open("/dev/null", O_WRONLY);
+        if (null_fd >= 0) {
+            std::cout.flush();
+            dup2(null_fd, STDOUT_FILENO);
+            close(null_fd);
+        }
+#ifdef _OPENMP
+        if (opt.threads > 0) omp_set_num_threads(opt.threads);
+#endif
+
+        const bool is2D = is_2D_case("../data/control.txt");
+        StreamingPipeline pipeline("../data/wave.csv", "../data/control.txt", "../data/ctrl.txt",
+                                   is2D, opt.elevation_mode, false, is2D ? 40.0 : 0.0, is2D ? 6 : 0,
+                                   opt.wheeler, false, opt.workers, 0, opt.acceleration_order);
+        pipeline.run();
+
+        const StreamingPipeline::StageTimes& t = pipeline.stage_times();
+        std::ostringstream line;
+        line << std::setprecision(9) << t.ingest << " " << t.compute << " " << t.write << " "
+             << t.total << " " << t.timesteps;
+        write_all(out_fd, line.str());
+    }, output, result.peak_mb);
+
+    std::istringstream in(output);
+    if (status != 0 || !(in >> result.times.ingest >> result.times.compute >> result.times.write
+                            >> result.times.total >> result.times.timesteps)) {
+        throw std::runtime_error("Pipeline run failed in " + c.dir.string());
+    }
+    return result;
+}
+
+// Comma-separated list of positive numbers
+template <typename T>
+std::vector<T> parse_number_list(const std::string& option, const std::string& text) {
+    std::vector<T> values;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        char* end = nullptr;
+        const double v = std::strtod(item.c_str(), &end);
+        if (end == item.c_str() || *end != '\0' || v <= 0) {
+            throw std::invalid_argument("invalid value for " + option + ": " + item);
+        }
+        values.push_back(static_cast<T>(v));
+    }
+    return values;
+}
\ No newline at end of file
@@ -0,0 +1,178 @@
+// scaling_harness.cpp
+//
+// End-to-end scaling runs of the StreamingPipeline on synthetic wavefields:
+//
+//   reef2fast_scaling [options]
+//
+// --control FILE   control.txt of the case (default: a 400 m x 200 m x 20 m box,
+//                  SeaState grid 40 x 20 x 10)
+// --ctrl FILE      ctrl.txt of the case (default: WaveDT 0.25 s, Hs 1.5 m, Tp 8 s)
+// --refine R,...   raw cells per SeaState cell, one problem size each (default 1,2)
+// --timesteps N,.. frames per run (default 20)
+// --threads T,...  OpenMP thread counts (default 1, 2, 4, ... up to the maximum)
+// --workers W      timesteps computed concurrently in every run (default 1)
+// --work-dir DIR   case directories and wavefield CSVs (default reef2fast_scaling)
+// --csv FILE       also write every run as one CSV line
+//
+// Strong scaling: every (refine, timesteps) problem runs with every thread
+// count. Weak scaling: the raw points per frame grow with the thread count,
+// starting from the first refine and timestep count. Runs are child processes
+// (see harness.hpp); per-stage times are those of
+// StreamingPipeline::stage_times(). The wavefield CSVs are generated once per
+// problem size with the Airy wave of synthetic_wavefield.hpp.
+
+#include "harness.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct RunResult {
+    fs::path dir;
+    size_t points;               // raw points per frame
+    int timesteps;
+    int threads;
+    StreamingPipeline::StageTimes times;
+    double peak_mb;
+};
+
+struct Options {
+    std::string control_text = DEFAULT_HARNESS_CONTROL;
+    std::string ctrl_text = DEFAULT_HARNESS_CTRL;
+    std::vector<double> refine = {1.0, 2.0};
+    std::vector<int> timesteps = {20};
+    std::vector<int> threads;
+    int workers = 1;
+    fs::path work_dir = "reef2fast_scaling";
+    std::string csv_file;
+};
+
+SyntheticCase prepare_problem(const Options& opt, double refine, int timesteps) {
+    std::ostringstream name;
+    name << "refine_" << refine << "_steps_" << timesteps;
+    return prepare_synthetic_case(opt.work_dir / name.str(), opt.control_text, opt.ctrl_text, refine, timesteps);
+}
+
+RunResult run_problem(const Options& opt, const SyntheticCase& c, int threads) {
+    PipelineRunOptions run;
+    run.workers = opt.workers;
+    run.threads = threads;
+    const PipelineRunResult r = run_pipeline_case(c, run);
+    return RunResult{c.dir, c.grid.points(), c.timesteps, threads, r.times, r.peak_mb};
+}
+
+void print_table(const std::string& title, const std::vector<RunResult>& runs) {
+    const bool weak = (title.find("Weak") == 0);
+    std::cout << "\n" << title << "\n"
+              << std::right << std::setw(12) << "points" << std::setw(7) << "steps"
+              << std::setw(8) << "threads" << std::setw(10) << "wall_s" << std::setw(10) << "ingest_s"
+              << std::setw(11) << "compute_s" << std::setw(10) << "write_s" << std::setw(10) << "peak_MB"
+              << std::setw(11) << (weak ? "throughput" : "speedup") << std::setw(11) << "efficiency" << "\n";
+
+    // Relative to the first run of each group. Strong: speedup of the wall time
+    // and speedup per thread. Weak: points x steps per second and wall time.
+    const RunResult* base = nullptr;
+    for (const RunResult& r : runs) {
+        if (!base || (!weak && (r.dir != base->dir))) base = &r;
+
+        const double speedup = base->times.total / r.times.total;
+        const double strong = speedup * base->threads / r.threads;
+        const double throughput = speedup * static_cast<double>(r.points) * r.timesteps /
+                                  (static_cast<double>(base->points) * base->timesteps);
+        std::cout << std::setw(12) << r.points << std::setw(7) << r.timesteps
+                  << std::setw(8) << r.threads << std::fixed << std::setprecision(3)
+                  << std::setw(10) << r.times.total << std::setw(10) << r.times.ingest
+                  << std::setw(11) << r.times.compute << std::setw(10) << r.times.write
+                  << std::setprecision(1) << std::setw(10) << r.peak_mb << std::setprecision(2)
+                  << std::setw(11) << (weak ? throughput : speedup) << std::setw(11) << (weak ? speedup : strong)
+                  << std::defaultfloat << "\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+            const std::string value = argv[++i];
+            if (arg == "--control") opt.control_text = read_text_file(value);
+            else if (arg == "--ctrl") opt.ctrl_text = read_text_file(value);
+            else if (arg == "--refine") opt.refine = parse_number_list<double>(arg, value);
+            else if (arg == "--timesteps") opt.timesteps = parse_number_list<int>(arg, value);
+            else if (arg == "--threads") opt.threads = parse_number_list<int>(arg, value);
+            else if (arg == "--workers") opt.workers = parse_number_list<int>(arg, value).at(0);
+            else if (arg == "--work-dir") opt.work_dir = value;
+            else if (arg == "--csv") opt.csv_file = value;
+            else throw std::invalid_argument("unknown option " + arg);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n"
+                  << "Usage: " << argv[0] << " [--control FILE] [--ctrl FILE] [--refine R,...]"
+                  << " [--timesteps N,...] [--threads T,...] [--workers W] [--work-dir DIR] [--csv FILE]\n";
+        return 2;
+    }
+
+    if (opt.threads.empty()) {
+        const int max_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        for (int t = 1; t < max_threads; t *= 2) opt.threads.push_back(t);
+        opt.threads.push_back(max_threads);
+    }
+
+    std::vector<RunResult> strong, weak;
+    try {
+        for (double refine : opt.refine) {
+            for (int steps : opt.timesteps) {
+                const SyntheticCase c = prepare_problem(opt, refine, steps);
+                for (int threads : opt.threads) {
+                    std::cerr << "Strong: " << c.grid.points() << " points, " << steps << " steps, "
+                              << threads << " threads\n";
+                    strong.push_back(run_problem(opt, c, threads));
+                }
+            }
+        }
+
+        // Raw points grow with the thread count: refine scales with its cube
+        // root in 3D (square root in 2D, where y stays one cell)
+        const bool is2D = prepare_problem(opt, opt.refine.front(), opt.timesteps.front()).grid.is2D;
+        for (int threads : opt.threads) {
+            const double scale = std::pow(static_cast<double>(threads) / opt.threads.front(), is2D ? 0.5 : 1.0 / 3.0);
+            const double refine = std::round(opt.refine.front() * scale * 100.0) / 100.0;
+            const SyntheticCase c = prepare_problem(opt, refine, opt.timesteps.front());
+            std::cerr << "Weak: " << c.grid.points() << " points, " << threads << " threads\n";
+            weak.push_back(run_problem(opt, c, threads));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    print_table("Weak scaling (points per frame grow with threads; points x steps per second and efficiency = first wall / wall, vs. the first run)", weak);
+    print_table("Weak scaling (points per frame grow with threads; throughput = points x steps per second\n                  vs. the first run, efficiency = first wall / wall)", weak);
+
+    if (!opt.csv_file.empty()) {
+        std::ofstream csv(opt.csv_file);
+        csv << "mode,points,timesteps,threads,workers,wall_s,ingest_s,compute_s,write_s,peak_mb\n";
+        for (const auto* runs : {&strong, &weak}) {
+            for (const RunResult& r : *runs) {
+                csv << (runs == &strong ? "strong" : "weak") << "," << r.points << ","
+                    << r.timesteps << "," << r.threads << "," << opt.workers << ","
+                    << r.times.total << "," << r.times.ingest << "," << r.times.compute << ","
+                    << r.times.write << "," << r.peak_mb << "\n";
+            }
+        }
+    }
+
+    return 0;
+}
\ No newline at end of file